@@ -9,21 +9,55 @@
 #include <tuple>
 #include <cstddef> // size_t and some other types
 #include <cstring>
+#include <memory_resource>
+#include <type_traits>
 
 namespace salad {
-    static int copies = 0;
+    // Tag for the size constructor: skip zeroing memory that's about to be overwritten anyway
+    struct uninitialized_t {
+        explicit uninitialized_t() = default;
+    };
+    inline constexpr uninitialized_t uninitialized{};
+
+    // Non-owning window into an Array (or any contiguous memory), trivially copyable so it can be passed
+    // around and re-sliced by value without ever touching the elements
+    template<typename T>
+    struct ArrayView {
+        T* data = nullptr;
+        size_t size = 0;
+
+        // Index operator
+        T& operator[](size_t idx) const { return data[idx]; }
+        // Slicing operator, the bounds are clamped to the view
+        ArrayView operator[](const std::tuple<size_t, size_t>& slice) const;
+
+        T* begin() const { return data; }
+        T* end() const { return data + size; }
+    };
+    static_assert(std::is_trivially_copyable_v<ArrayView<int>>);
+
     template<typename T>
     struct Array {
         T* data;
         size_t size;
         bool owner;
+        // Where owned data came from, nullptr if it was allocated with new[]
+        std::pmr::memory_resource* resource = nullptr;
+        // Number of elements allocated, size may be shrunk below it
+        size_t capacity = 0;
 
-        Array(T* data, size_t size, const bool owner=true) : data(data), size(size), owner(owner) {}
-        explicit Array(size_t size) : data(new T[size]), size(size), owner(true) {
+        Array(T* data, size_t size, const bool owner=true) : data(data), size(size), owner(owner), capacity(size) {}
+        // Allocates from resource, the current default resource if none is given
+        explicit Array(size_t size, std::pmr::memory_resource* resource = nullptr)
+            : Array(size, uninitialized, resource) {
             std::memset(data, 0, sizeof(T) * size);
         }
+        Array(size_t size, uninitialized_t, std::pmr::memory_resource* resource = nullptr);
 
-        Array(const Array& other);
+        // Deep copies are opt-in, either spelled out as Array(other) or other.clone()
+        explicit Array(const Array& other);
+        // Takes over other's data (and ownership of it), leaving other empty
+        Array(Array&& other) noexcept;
         ~Array();
     
         static Array from(T* data, size_t size) {
@@ -34,10 +68,21 @@ namespace salad {
         // Index operator
         T& operator[](size_t idx) const;
         // Slicing operator
-        Array operator[](const std::tuple<size_t, size_t>& slice) const;
-        Array& operator=(const Array& other);
+        ArrayView<T> operator[](const std::tuple<size_t, size_t>& slice) const;
+        Array& operator=(const Array& other) = delete;
 
         Array& operator=(Array&& other) noexcept;
+
+        [[nodiscard]] Array clone() const { return Array(*this); }
+        [[nodiscard]] ArrayView<T> view() const { return {data, size}; }
+        operator ArrayView<T>() const { return view(); }
+
+        T* begin() const { return data; }
+        T* end() const { return data + size; }
+
+    private:
+        // Frees owned data
+        void release();
     };
 }
 
@@ -7,28 +7,53 @@
 #ifndef ARR_UTIL_H
 #define ARR_UTIL_H
 #include "arr_util.dec.h"
+#include "instrument.h"
+#include "memory.h"
 #include "functional"
 #include <tuple>
 #include <iostream>
 #include <cstddef> // size_t and some other types
+#include <cstdint>
 #include <cstring>
+#include <type_traits>
 #include <fmt/format.h>
 
 namespace salad {
     template <typename T>
-    Array<T>::Array(const Array& other) : data(new T[other.size]), size(other.size), owner(true) {
+    Array<T>::Array(const size_t size, uninitialized_t, std::pmr::memory_resource* resource)
+        : data(nullptr), size(size), owner(true),
+          resource(resource != nullptr ? resource : std::pmr::get_default_resource()), capacity(size) {
+        static_assert(std::is_trivially_copyable_v<T>, "Array stores its elements as raw memory");
+        data = static_cast<T*>(this->resource->allocate(sizeof(T) * size, alignof(T)));
+        instrument::add(instrument::Counter::allocations, 1);
+        instrument::add(instrument::Counter::bytes_allocated, sizeof(T) * size);
+    }
+
+    // Copies allocate from the same resource as the original
+    template <typename T>
+    Array<T>::Array(const Array& other)
+        : Array(other.size, uninitialized, other.resource) {
         if (this != &other) {
             if (other.size < 1) {
                 return;
             }
 
-            salad::copies += other.size * sizeof(T);
+            instrument::add(instrument::Counter::bytes_copied, other.size * sizeof(T));
             std::memcpy(this->data, other.data, sizeof(T) * other.size);
-            return;
         }
+    }
 
-
-        this->data = other.data; // Let them alias
+    template <typename T>
+    void Array<T>::release() {
+        if (owner && data != nullptr) {
+            instrument::add(instrument::Counter::frees, 1);
+            if (resource != nullptr) {
+                resource->deallocate(data, sizeof(T) * capacity, alignof(T));
+            } else {
+                delete[] data;
+            }
+        }
+        data = nullptr;
     }
 
     template <typename T>
@@ -37,7 +62,7 @@ namespace salad {
     }
 
     template <typename T>
-    Array<T> Array<T>::operator[](const std::tuple<std::size_t, std::size_t>& slice) const {
+    ArrayView<T> ArrayView<T>::operator[](const std::tuple<std::size_t, std::size_t>& slice) const {
         std::size_t start = std::get<0>(slice);
         std::size_t end = std::get<1>(slice);
         if (end > this->size) {
@@ -46,40 +71,39 @@ namespace salad {
 
         start = start < end ? start : end;
         
-        size_t new_size = end - start;
-        return Array{this->data + start, new_size, false};
+        return ArrayView{this->data + start, end - start};
     }
 
     template <typename T>
-    Array<T>& Array<T>::operator=(const Array& other) {
-        {
-            if (this != &other) {
-                if (owner && data != nullptr) {
-                    delete[] data;
-                }
+    ArrayView<T> Array<T>::operator[](const std::tuple<std::size_t, std::size_t>& slice) const {
+        return view()[slice];
+    }
 
-                data = new T[other.size];
-                salad::copies += other.size * sizeof(T);
-                std::memcpy(data, other.data, sizeof(T) * other.size);
-                size = other.size;
-                owner = true;
-            }
-            
-            return *this;
-        }
+    template <typename T>
+    Array<T>::Array(Array&& other) noexcept
+        : data(other.data), size(other.size), owner(other.owner), resource(other.resource), capacity(other.capacity) {
+        other.data = nullptr;
+        other.size = 0;
+        other.capacity = 0;
+        other.owner = false;
     }
 
     template<typename T>
     Array<T>& Array<T>::operator=(Array&& other) noexcept {
         {
             if (this != &other) {
-                if (owner && data != nullptr) {
-                    delete[] data;
-                }
+                release();
 
                 data = other.data;
                 size = other.size;
-                owner = false;
+                owner = other.owner;
+                resource = other.resource;
+                capacity = other.capacity;
+
+                other.data = nullptr;
+                other.size = 0;
+                other.capacity = 0;
+                other.owner = false;
             }
             
             return *this;
@@ -88,14 +112,12 @@ namespace salad {
 
     template <typename T>
     Array<T>::~Array() {
-        if (owner && data != nullptr) {
-            delete[] data;
-        }
+        release();
     }
 
     inline int test() {
         using arrT = int;
-        std::function<std::string(Array<arrT>&)> repr = [](Array<arrT>& a) {
+        std::function<std::string(ArrayView<arrT>)> repr = [](ArrayView<arrT> a) {
             std::string repr;
             for (size_t i = 0; i < a.size; i++) {
                 repr += std::to_string(a[i]);
@@ -112,16 +134,67 @@ namespace salad {
         memcpy(arr_data, arr, sizeof(arrT) * 6);
         delete[] arr;
         Array<arrT> a = Array<arrT>::from(reinterpret_cast<arrT*>(arr_data), 6);
-        Array<arrT> a_splice = a[{1,4}];
-        Array<arrT> a_copy = a;
+        ArrayView<arrT> a_splice = a[{1,4}];
+        Array<arrT> a_copy = a.clone();
         std::cout << "..:: Array Utility Test ::..\n"
                   << fmt::format("Copy doesn't alias: {:s}\n", a.data != a_copy.data)
                   << fmt::format("Array:\t\t {:s}\n", repr(a))
                   << fmt::format("Array[{:d}:{:d}]:\t {:s}\n", 1, 4, repr(a_splice))
                   << std::endl;
-                  
-        
-        return 0;
+
+        // Counts what the arena and the pool ask of the default resource
+        struct CountingResource : std::pmr::memory_resource {
+            size_t allocations = 0;
+
+            void* do_allocate(const size_t bytes, const size_t alignment) override {
+                allocations++;
+                return std::pmr::get_default_resource()->allocate(bytes, alignment);
+            }
+            void do_deallocate(void* p, const size_t bytes, const size_t alignment) override {
+                std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+            }
+            [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+        };
+
+        CountingResource upstream;
+        bool aligned = true;
+        bool reused = false;
+        bool fell_back = false;
+        {
+            ArenaResource arena(1 << 10, &upstream);
+            for (const size_t alignment : {1, 8, 64, 256}) {
+                void* p = arena.allocate(3, alignment);
+                aligned = aligned && reinterpret_cast<uintptr_t>(p) % alignment == 0;
+            }
+            // Doesn't fit in the first block, the next comes from upstream and is kept by release()
+            const size_t blocks = upstream.allocations;
+            void* large = arena.allocate(4 << 10);
+            fell_back = upstream.allocations == blocks + 1;
+
+            arena.release();
+            reused = arena.allocate(16) == large && upstream.allocations == blocks + 1 && arena.used() == 16;
+        }
+
+        bool recycled = false;
+        {
+            PoolResource pool(&upstream);
+            void* p = pool.allocate(100);
+            pool.deallocate(p, 100);
+            const size_t allocations = upstream.allocations;
+            recycled = pool.allocate(120) == p && upstream.allocations == allocations;
+            pool.deallocate(p, 120);
+        }
+
+        std::cout << "..:: Memory Resource Test ::..\n"
+                  << fmt::format("Arena keeps alignment: {:s}\n", aligned)
+                  << fmt::format("Arena falls back to upstream: {:s}\n", fell_back)
+                  << fmt::format("Arena reuses its block after release: {:s}\n", reused)
+                  << fmt::format("Pool recycles freed blocks: {:s}\n", recycled)
+                  << std::endl;
+
+        return aligned && fell_back && reused && recycled ? 0 : 1;
     }
 }
 #endif //ARR_UTIL_H
\ No newline at end of file
@@ -0,0 +1,354 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "block_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace salad {
+    // Mapped submission and completion rings, see io_uring_setup(2). liburing isn't needed for the handful
+    // of operations used here: plain reads at an offset, submitted and reaped by one thread
+    struct BlockReader::Uring {
+        int fd = -1;
+        void* sq_ring = nullptr;
+        size_t sq_ring_size = 0;
+        void* cq_ring = nullptr;
+        size_t cq_ring_size = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqes_size = 0;
+
+        unsigned* sq_tail = nullptr;
+        unsigned sq_mask = 0;
+        unsigned* sq_array = nullptr;
+        unsigned* cq_head = nullptr;
+        unsigned* cq_tail = nullptr;
+        unsigned cq_mask = 0;
+        io_uring_cqe* cqes = nullptr;
+
+        ~Uring() {
+            if (sqes != nullptr) {
+                munmap(sqes, sqes_size);
+            }
+            if (cq_ring != nullptr && cq_ring != sq_ring) {
+                munmap(cq_ring, cq_ring_size);
+            }
+            if (sq_ring != nullptr) {
+                munmap(sq_ring, sq_ring_size);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        int enter(const unsigned submit, const unsigned wait) const {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0,
+                                            nullptr, 0));
+        }
+    };
+
+    BlockReader::BlockReader(const int fd, const size_t block_size, const size_t depth)
+        : fd(fd), block_size(block_size) {
+        buffers.reserve(depth);
+        for (size_t i = 0; i < depth; i++) {
+            buffers.push_back(Buffer{Array<char>(block_size, uninitialized)});
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && setup_uring()) {
+            for (size_t i = 0; i < buffers.size(); i++) {
+                buffers[i].offset = next_offset;
+                next_offset += block_size;
+                submit_read(i);
+            }
+            return;
+        }
+        reader = std::thread([this] { reader_loop(); });
+    }
+
+    BlockReader::~BlockReader() {
+        if (uring != nullptr) {
+            // The kernel may still be writing into the buffers, entries it never took don't matter
+            while (in_flight > unsubmitted && wait_completions()) {}
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        free_cv.notify_all();
+        if (reader.joinable()) {
+            reader.join();
+        }
+    }
+
+    std::string_view BlockReader::next() {
+        return uring != nullptr ? next_uring() : next_threaded();
+    }
+
+    bool BlockReader::setup_uring() {
+        io_uring_params params{};
+        const int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(buffers.size()), &params));
+        if (ring_fd < 0) {
+            return false;
+        }
+        auto ring = std::make_unique<Uring>();
+        ring->fd = ring_fd;
+        // IORING_OP_READ came with the same kernel (5.6) as this feature flag
+        if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+            return false;
+        }
+
+        ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            ring->sq_ring_size = ring->cq_ring_size = std::max(ring->sq_ring_size, ring->cq_ring_size);
+        }
+
+        void* sq = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                        IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) {
+            return false;
+        }
+        ring->sq_ring = sq;
+        if (single_mmap) {
+            ring->cq_ring = sq;
+        } else {
+            void* cq = mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                            IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) {
+                return false;
+            }
+            ring->cq_ring = cq;
+        }
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* entries = mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                             IORING_OFF_SQES);
+        if (entries == MAP_FAILED) {
+            return false;
+        }
+        ring->sqes = static_cast<io_uring_sqe*>(entries);
+
+        char* sq_base = static_cast<char*>(ring->sq_ring);
+        char* cq_base = static_cast<char*>(ring->cq_ring);
+        ring->sq_tail = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+        ring->sq_mask = *reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+        ring->sq_array = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+        ring->cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+        ring->cq_mask = *reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+
+        uring = std::move(ring);
+        return true;
+    }
+
+    // Reads the rest of a buffer's block, a short read resubmits from where it stopped
+    void BlockReader::submit_read(const size_t index) {
+        Buffer& buffer = buffers[index];
+        const unsigned tail = *uring->sq_tail;
+        const unsigned slot = tail & uring->sq_mask;
+
+        io_uring_sqe& sqe = uring->sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer.data.data + buffer.filled);
+        sqe.len = static_cast<uint32_t>(block_size - buffer.filled);
+        sqe.off = buffer.offset + buffer.filled;
+        sqe.user_data = index;
+        uring->sq_array[slot] = slot;
+
+        // The kernel must see the entry before the new tail
+        __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+        in_flight++;
+        unsubmitted++;
+        submit_pending();
+    }
+
+    // Hands the queued entries to the kernel. Ones it can't take right now (EAGAIN or EBUSY under memory
+    // pressure, or with completions to reap first) stay queued and go along with the next wait_completions()
+    void BlockReader::submit_pending() {
+        while (unsubmitted > 0) {
+            const int submitted = uring->enter(static_cast<unsigned>(unsubmitted), 0);
+            if (submitted < 0 && errno == EINTR) {
+                continue;
+            }
+            if (submitted <= 0) {
+                return;
+            }
+            unsubmitted -= submitted;
+        }
+    }
+
+    bool BlockReader::wait_completions() {
+        const int submitted = uring->enter(static_cast<unsigned>(unsubmitted), 1);
+        if (submitted >= 0) {
+            unsubmitted -= submitted;
+        } else if (errno == EAGAIN || errno == EBUSY) {
+            // Nothing was submitted. Reaping what the kernel already has frees it up for the next try, with
+            // nothing to reap the next try only comes after giving way to the rest of the system
+            if (in_flight > unsubmitted) {
+                const int waited = uring->enter(0, 1);
+                if (waited < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    read_error = errno;
+                    return false;
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        } else if (errno != EINTR) {
+            read_error = errno;
+            return false;
+        }
+
+        unsigned head = *uring->cq_head;
+        const unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = uring->cqes[head & uring->cq_mask];
+            const size_t index = cqe.user_data;
+            const int result = cqe.res;
+            Buffer& buffer = buffers[index];
+            in_flight--;
+
+            if (result == -EINTR || result == -EAGAIN) {
+                submit_read(index);
+            } else if (result < 0) {
+                read_error = read_error != 0 ? read_error : -result;
+                buffer.ready = true;
+                buffer.end = true;
+            } else if (result == 0 || buffer.filled + result == block_size) {
+                buffer.filled += result;
+                buffer.ready = true;
+                buffer.end = buffer.filled == 0;
+            } else {
+                buffer.filled += result;
+                submit_read(index);
+            }
+        }
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    std::string_view BlockReader::next_uring() {
+        if (finished) {
+            return {};
+        }
+        if (holding) {
+            // The consumer is done with the previous block, its buffer reads the next one not yet in flight
+            Buffer& previous = buffers[(current + buffers.size() - 1) % buffers.size()];
+            previous.offset = next_offset;
+            previous.filled = 0;
+            previous.ready = false;
+            previous.end = false;
+            next_offset += block_size;
+            submit_read((current + buffers.size() - 1) % buffers.size());
+        }
+
+        Buffer& buffer = buffers[current];
+        while (!buffer.ready) {
+            if (!wait_completions()) {
+                finished = true;
+                return {};
+            }
+        }
+        holding = true;
+        current = (current + 1) % buffers.size();
+        if (buffer.end) {
+            finished = true;
+            return {};
+        }
+        return {buffer.data.data, buffer.filled};
+    }
+
+    void BlockReader::reader_loop() {
+        for (size_t index = 0;; index = (index + 1) % buffers.size()) {
+            Buffer& buffer = buffers[index];
+            {
+                std::unique_lock lock(mutex);
+                free_cv.wait(lock, [&] { return stopping || !buffer.ready; });
+                if (stopping) {
+                    return;
+                }
+            }
+
+            // Blocks are filled completely unless the input ends, so the consumer's view of the blocks doesn't
+            // depend on how a pipe happened to chunk the data
+            size_t filled = 0;
+            int error = 0;
+            bool eof = false;
+            while (filled < block_size) {
+                const ssize_t got = read(fd, buffer.data.data + filled, block_size - filled);
+                if (got < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    error = errno;
+                    break;
+                }
+                if (got == 0) {
+                    eof = true;
+                    break;
+                }
+                filled += got;
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                buffer.filled = filled;
+                buffer.ready = true;
+                buffer.end = filled == 0 || error != 0;
+                read_error = read_error != 0 ? read_error : error;
+            }
+            filled_cv.notify_one();
+
+            if (error != 0 || (eof && filled == 0)) {
+                return;
+            }
+            if (eof) {
+                // The next buffer tells the consumer the input has ended
+                Buffer& last = buffers[(index + 1) % buffers.size()];
+                std::unique_lock lock(mutex);
+                free_cv.wait(lock, [&] { return stopping || !last.ready; });
+                last.filled = 0;
+                last.ready = true;
+                last.end = true;
+                lock.unlock();
+                filled_cv.notify_one();
+                return;
+            }
+        }
+    }
+
+    std::string_view BlockReader::next_threaded() {
+        std::unique_lock lock(mutex);
+        if (finished) {
+            return {};
+        }
+        if (holding) {
+            buffers[(current + buffers.size() - 1) % buffers.size()].ready = false;
+            free_cv.notify_one();
+        }
+
+        Buffer& buffer = buffers[current];
+        filled_cv.wait(lock, [&] { return buffer.ready; });
+        holding = true;
+        current = (current + 1) % buffers.size();
+        if (buffer.end) {
+            finished = true;
+            return {};
+        }
+        return {buffer.data.data, buffer.filled};
+    }
+}
@@ -0,0 +1,86 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef BLOCK_READER_H
+#define BLOCK_READER_H
+#include <condition_variable>
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "arr_util.h"
+
+namespace salad {
+    // Reads a file descriptor ahead of its consumer, in fixed-size blocks that go round a ring of buffers.
+    // Regular files keep every free buffer's read in flight through io_uring when the kernel allows it,
+    // everything else (pipes, stdin, kernels without io_uring, seccomp filters that block it) gets a reader
+    // thread that blocks in read() instead. The consumer sees the blocks in file order either way
+    class BlockReader {
+    public:
+        static constexpr size_t default_block_size = 4 << 20;
+        static constexpr size_t default_depth = 4;
+
+        // fd stays owned by the caller and must outlive the reader
+        explicit BlockReader(int fd, size_t block_size = default_block_size, size_t depth = default_depth);
+        BlockReader(const BlockReader&) = delete;
+        BlockReader& operator=(const BlockReader&) = delete;
+        ~BlockReader();
+
+        // Next block, empty once the input has ended (or reading failed, see error()). Hands the previous
+        // block's buffer back to the reader, so a view is only valid until the next call
+        std::string_view next();
+
+        // errno of the first failed read, 0 if there was none
+        [[nodiscard]] int error() const { return read_error; }
+        [[nodiscard]] bool uses_uring() const { return uring != nullptr; }
+
+    private:
+        struct Buffer {
+            Array<char> data;
+            uint64_t offset = 0;    // io_uring only, where in the file the block starts
+            size_t filled = 0;
+            bool ready = false;     // Filled (or at the end of the input), waiting for the consumer
+            bool end = false;       // Nothing was left to read at this block
+        };
+
+        // Rings shared with the kernel, only set up for regular files
+        struct Uring;
+
+        bool setup_uring();
+        void submit_read(size_t index);
+        void submit_pending();
+        bool wait_completions();
+        std::string_view next_uring();
+
+        void reader_loop();
+        std::string_view next_threaded();
+
+        int fd;
+        size_t block_size;
+        std::vector<Buffer> buffers;
+        size_t current = 0;         // Buffer the consumer gets next
+        bool holding = false;       // The consumer still has the buffer before current
+        int read_error = 0;
+        bool finished = false;      // The end of the input (or an error) was handed to the consumer
+
+        std::unique_ptr<Uring> uring;
+        uint64_t next_offset = 0;   // Where the next block submitted to io_uring starts
+        size_t in_flight = 0;       // Reads the kernel may still write into a buffer for
+        size_t unsubmitted = 0;     // Of those, the ones still queued that the kernel hasn't taken yet
+
+        // Reader thread state
+        std::thread reader;
+        std::mutex mutex;
+        std::condition_variable filled_cv;
+        std::condition_variable free_cv;
+        bool stopping = false;
+    };
+}
+
+#endif //BLOCK_READER_H
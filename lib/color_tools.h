@@ -6,10 +6,14 @@
 #define COLOR_TOOLS_H
 
 #include <array>
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 #include <algorithm>
+#include <fmt/compile.h>
 #include <fmt/format.h>
 
 namespace salad {
@@ -63,96 +67,216 @@ namespace salad {
         LIME = rgb_cube[0][5][2]
     };
     
-    inline std::string color_string(const std::string_view& str, const short fcolor = -1, const short bcolor = -1) {
-        // Check if the string is already formatted like a color string
-        // By checking if there's a sequence of adjacent [ESC, 38|48, ;, 5, ;
-        std::string ret = std::string(str);
-        if (str.find("\033[38;5;") != std::string::npos) {
-            // Extract the string, find the first 'm' after the sequence
-            std::size_t pos = str.find('m', str.find("\033[38;5;") + 8);
-            std::size_t rst_pos = str.find("\033[0m", pos);
-
-            if (pos == std::string::npos || rst_pos == std::string::npos) {
-                return {str.begin(), str.end()};
-            }
-            
-            ret = str.substr(pos + 1, rst_pos - (pos + 1));
+    // Escape sequence that switches to a foreground and/or background colour (-1 for none), precomputed so
+    // rendering only copies it
+    struct ColorEscape {
+        std::array<char, 24> chars{};   // Longest is "\033[38;5;255;48;5;255m"
+        uint8_t size = 0;               // 0 if neither colour is set
+
+        [[nodiscard]] constexpr std::string_view view() const { return {chars.data(), size}; }
+    };
+
+    inline constexpr std::string_view color_reset = "\033[0m";
+
+    namespace color_detail {
+        constexpr char lower(const char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
         }
-            
-        switch ((fcolor != -1) + (bcolor != -1) << 1) {
-        case 0b00: 
-            return {ret.begin(), ret.end()};
-        case 0b10:
-            return fmt::format("\033[38;5;{:d}m{:s}\033[0m", fcolor, ret);
-        case 0b01:
-            return fmt::format("\033[48;5;{:d}m{:s}\033[0m", bcolor, ret);
-        case 0b11:
-            return fmt::format("\033[38;5;{:d};48;5;{:d}m{:s}\033[0m", fcolor, bcolor, ret);
-        default:
-            __builtin_unreachable();
+
+        constexpr bool is_space(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
         }
-    }
 
-    // Assuming the previous definitions are present, including rgb_cube, rgb_greys, rgb_standard, and COLOR enum
+        constexpr std::string_view trimmed(std::string_view s) {
+            while (!s.empty() && is_space(s.front())) {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && is_space(s.back())) {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
 
-    // Function to map color specifications to 8-bit color codes
-    inline short parse_color(const std::string& color_value, const rgb_cube_t& rgb_cube) {
-        if (color_value.empty()) return -1;
-
-        // Map of color names to their corresponding COLOR enum values
-        static const std::unordered_map<std::string, short> color_map = {
-            {"black", BLACK},
-            {"white", WHITE},
-            {"grey", GREY},
-            {"red", RED},
-            {"green", GREEN},
-            {"blue", BLUE},
-            {"yellow", YELLOW},
-            {"magenta", MAGENTA},
-            {"cyan", CYAN},
-            {"orange", ORANGE},
-            {"pink", PINK},
-            {"purple", PURPLE},
-            {"teal", TEAL},
-            {"lime", LIME}
-        };
+        // Whole of s as a number up to max, -1 if it's anything else
+        constexpr int small_number(const std::string_view s, const int max) {
+            if (s.empty() || s.size() > 3) {
+                return -1;
+            }
+            int value = 0;
+            for (const char c : s) {
+                if (c < '0' || c > '9') {
+                    return -1;
+                }
+                value = value * 10 + (c - '0');
+            }
+            return value <= max ? value : -1;
+        }
 
-        // Convert color_value to lowercase for case-insensitive matching
-        std::string color_lower = color_value;
-        std::transform(color_lower.begin(), color_lower.end(), color_lower.begin(), ::tolower);
+        constexpr void append(ColorEscape& escape, const std::string_view text) {
+            for (const char c : text) {
+                escape.chars[escape.size++] = c;
+            }
+        }
+
+        constexpr void append(ColorEscape& escape, const short code) {
+            char digits[3];
+            size_t count = 0;
+            int value = code;
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            while (count > 0) {
+                escape.chars[escape.size++] = digits[--count];
+            }
+        }
 
-        // Check if the color is a named color
-        auto it = color_map.find(color_lower);
-        if (it != color_map.end()) {
-            return it->second;
+        inline constexpr std::array<std::pair<std::string_view, short>, 14> named_colors = {{
+            {"black", BLACK}, {"white", WHITE}, {"grey", GREY}, {"red", RED}, {"green", GREEN}, {"blue", BLUE},
+            {"yellow", YELLOW}, {"magenta", MAGENTA}, {"cyan", CYAN}, {"orange", ORANGE}, {"pink", PINK},
+            {"purple", PURPLE}, {"teal", TEAL}, {"lime", LIME},
+        }};
+
+        // The names are hashed (FNV-1a on the lower-cased characters, top bits) into a table twice their count.
+        // The seed is searched for at compile time until no two names share a slot, so a lookup is one hash,
+        // one table load and one comparison
+        inline constexpr size_t name_slot_bits = 5;
+        static_assert(named_colors.size() <= (1 << name_slot_bits) / 2);
+
+        constexpr size_t name_slot(const std::string_view name, const uint32_t seed) {
+            uint32_t hash = seed;
+            for (const char c : name) {
+                hash = (hash ^ static_cast<uint8_t>(lower(c))) * 16777619u;
+            }
+            return hash >> (32 - name_slot_bits);
         }
 
-        // Check if the color_value is a pure numeric 8-bit code
-        if (std::all_of(color_value.begin(), color_value.end(), ::isdigit)) {
-            int code = std::stoi(color_value);
-            if (code >= 0 && code <= 255) return static_cast<short>(code);
+        constexpr uint32_t find_name_seed() {
+            for (uint32_t seed = 2166136261u;; seed++) {
+                bool taken[1 << name_slot_bits] = {};
+                bool collision = false;
+                for (const auto& [name, code] : named_colors) {
+                    const size_t slot = name_slot(name, seed);
+                    collision |= taken[slot];
+                    taken[slot] = true;
+                }
+                if (!collision) {
+                    return seed;
+                }
+            }
         }
 
-        // Check if the color_value is an RGB triplet in the format "r,g,b"
-        size_t first_comma = color_value.find(',');
-        if (first_comma != std::string::npos) {
-            size_t second_comma = color_value.find(',', first_comma + 1);
-            if (second_comma != std::string::npos) {
-                try {
-                    short r = std::stoi(color_value.substr(0, first_comma));
-                    int g = std::stoi(color_value.substr(first_comma + 1, second_comma - first_comma - 1));
-                    int b = std::stoi(color_value.substr(second_comma + 1));
-                    if (r >= 0 && r <= 5 && g >= 0 && g <= 5 && b >= 0 && b <= 5) {
-                        return static_cast<short>(rgb_cube[r][g][b]);
-                    }
-                } catch (...) {
-                    // Invalid RGB values; fall through to return -1
+        inline constexpr uint32_t name_seed = find_name_seed();
+
+        // Index into named_colors for every slot, -1 for empty ones
+        inline constexpr std::array<int8_t, 1 << name_slot_bits> name_table = [] {
+            std::array<int8_t, 1 << name_slot_bits> table{};
+            table.fill(-1);
+            for (size_t i = 0; i < named_colors.size(); i++) {
+                table[name_slot(named_colors[i].first, name_seed)] = static_cast<int8_t>(i);
+            }
+            return table;
+        }();
+
+        constexpr short named_color(const std::string_view value) {
+            if (value.empty()) {
+                return -1;
+            }
+            const int8_t index = name_table[name_slot(value, name_seed)];
+            if (index < 0) {
+                return -1;
+            }
+            const auto& [name, code] = named_colors[index];
+            if (name.size() != value.size()) {
+                return -1;
+            }
+            for (size_t i = 0; i < name.size(); i++) {
+                if (lower(value[i]) != name[i]) {
+                    return -1;
                 }
             }
+            return code;
         }
 
-        // If all parsing attempts fail, return -1 indicating no color
-        return -1;
+        // Text that's already coloured (it has a foreground escape) loses its old colours, like color_string
+        // always did. ok is false if the escape isn't closed, such text is used as it is without colours
+        struct Stripped {
+            std::string_view text;
+            bool ok;
+        };
+
+        constexpr Stripped strip_color(const std::string_view str) {
+            const size_t escape = str.find("\033[38;5;");
+            if (escape == std::string_view::npos) {
+                return {str, true};
+            }
+            const size_t pos = str.find('m', escape + 8);
+            const size_t reset = str.find(color_reset, pos);
+            if (pos == std::string_view::npos || reset == std::string_view::npos) {
+                return {str, false};
+            }
+            return {str.substr(pos + 1, reset - (pos + 1)), true};
+        }
+    }
+
+    // 8-bit colour code of a name (case-insensitive), a code (0 to 255) or an "r,g,b" point of the colour
+    // cube (0 to 5 each), -1 for anything else
+    constexpr short color_code(const std::string_view color_value) {
+        if (const short named = color_detail::named_color(color_value); named >= 0) {
+            return named;
+        }
+        if (const int code = color_detail::small_number(color_value, 255); code >= 0) {
+            return static_cast<short>(code);
+        }
+
+        const size_t first_comma = color_value.find(',');
+        const size_t second_comma = color_value.find(',', first_comma + 1);
+        if (first_comma == std::string_view::npos || second_comma == std::string_view::npos) {
+            return -1;
+        }
+        const int r = color_detail::small_number(color_detail::trimmed(color_value.substr(0, first_comma)), 5);
+        const int g = color_detail::small_number(
+            color_detail::trimmed(color_value.substr(first_comma + 1, second_comma - first_comma - 1)), 5);
+        const int b = color_detail::small_number(color_detail::trimmed(color_value.substr(second_comma + 1)), 5);
+        if (r < 0 || g < 0 || b < 0) {
+            return -1;
+        }
+        return static_cast<short>(rgb_cube[r][g][b]);
+    }
+
+    constexpr ColorEscape color_escape(const short fcolor, const short bcolor) {
+        ColorEscape escape;
+        if (fcolor < 0 && bcolor < 0) {
+            return escape;
+        }
+        color_detail::append(escape, "\033[");
+        if (fcolor >= 0) {
+            color_detail::append(escape, "38;5;");
+            color_detail::append(escape, fcolor);
+        }
+        if (bcolor >= 0) {
+            color_detail::append(escape, fcolor >= 0 ? ";48;5;" : "48;5;");
+            color_detail::append(escape, bcolor);
+        }
+        color_detail::append(escape, "m");
+        return escape;
+    }
+
+    inline std::string color_string(const std::string_view& str, const short fcolor = -1, const short bcolor = -1) {
+        const auto [text, ok] = color_detail::strip_color(str);
+        const ColorEscape escape = color_escape(fcolor, bcolor);
+        if (!ok || escape.size == 0) {
+            return std::string(text);
+        }
+        std::string ret;
+        ret.reserve(escape.size + text.size() + color_reset.size());
+        ret.append(escape.view()).append(text).append(color_reset);
+        return ret;
+    }
+
+    // Function to map color specifications to 8-bit color codes
+    inline short parse_color(const std::string& color_value, const rgb_cube_t&) {
+        return color_code(color_value);
     }
 
     inline void trim(std::string& s) {
@@ -185,99 +309,164 @@ namespace salad {
         s = result;
     }
     
-    // Complete format_color function
-    inline std::string format_color(const std::string_view str) {
-        std::string ret;
-        ret.reserve(str.size()); // Reserve enough space to optimize performance
+    // One piece of a "{text:f color}" spec: text is either plain or wrapped in escape and a reset
+    struct ColorSegment {
+        std::string_view text;
+        ColorEscape escape{};
+        bool slot = false;      // "{:f color}" with no text, ColorFormat fills in an argument
+    };
 
+    // Splits str into segments and calls on_segment with each, in order. "{text:type color}" is coloured,
+    // type being f (foreground), b (background) or fb (both the same), and color anything color_code takes.
+    // Everything else, including braces that don't hold a valid spec, is plain text. Views point into str
+    template<typename F>
+    constexpr void for_each_color_segment(const std::string_view str, F&& on_segment) {
         size_t pos = 0;
-
         while (pos < str.size()) {
-            size_t start = str.find('{', pos);
-            if (start == std::string::npos) {
-                // No more color patterns; append the rest of the string
-                ret += std::string(str.substr(pos));
-                break;
+            const size_t start = str.find('{', pos);
+            const size_t end = start == std::string_view::npos ? start : str.find('}', start);
+            if (start == std::string_view::npos || end == std::string_view::npos) {
+                on_segment(ColorSegment{str.substr(pos)});
+                return;
             }
-
-            // Append the text before the '{'
-            ret += std::string(str.substr(pos, start - pos));
-
-            size_t end = str.find('}', start);
-            if (end == std::string::npos) {
-                // No closing '}', append the rest of the string and exit
-                ret += std::string(str.substr(start));
-                break;
+            if (start > pos) {
+                on_segment(ColorSegment{str.substr(pos, start - pos)});
             }
+            pos = end + 1;
 
-            // Extract the content within '{' and '}'
-            std::string inside = std::string(str.substr(start + 1, end - start - 1));
-
-            // Find the last ':' to split text and color specification
-            size_t colon = inside.rfind(':');
-            if (colon == std::string::npos) {
-                // No ':' found; treat as normal text
-                ret += "{" + inside + "}";
-                pos = end + 1;
+            // Invalid specs stay as they are, braces included
+            const std::string_view whole = str.substr(start, end - start + 1);
+            const std::string_view inside = whole.substr(1, whole.size() - 2);
+            const size_t colon = inside.rfind(':');
+            if (colon == std::string_view::npos) {
+                on_segment(ColorSegment{whole});
                 continue;
             }
-
-            // Split into text and color_spec
-            std::string text = inside.substr(0, colon);
-            std::string color_spec = inside.substr(colon + 1);
-            
-            trim(text);
-            trim(color_spec);
-
-            // Split color_spec into type and value
-            size_t space = color_spec.find(' ');
-            if (space == std::string::npos) {
-                // Invalid format; treat as normal text
-                ret += "{" + inside + "}";
-                pos = end + 1;
+            const std::string_view text = color_detail::trimmed(inside.substr(0, colon));
+            const std::string_view color_spec = color_detail::trimmed(inside.substr(colon + 1));
+            const size_t space = color_spec.find(' ');
+            if (space == std::string_view::npos) {
+                on_segment(ColorSegment{whole});
                 continue;
             }
 
-            std::string color_type = color_spec.substr(0, space);
-            std::string color_value = color_spec.substr(space + 1);
-
+            const std::string_view color_type = color_spec.substr(0, space);
+            const short color = color_code(color_spec.substr(space + 1));
             short fcolor = -1;
             short bcolor = -1;
-
-            // Determine the color type and parse accordingly
             if (color_type == "f") {
-                // Foreground color
-                fcolor = parse_color(color_value, rgb_cube);
-            }
-            else if (color_type == "b") {
-                // Background color
-                bcolor = parse_color(color_value, rgb_cube);
+                fcolor = color;
+            } else if (color_type == "b") {
+                bcolor = color;
+            } else if (color_type == "fb") {
+                fcolor = color;
+                bcolor = color;
+            } else {
+                on_segment(ColorSegment{whole});
+                continue;
             }
-            else if (color_type == "fb") {
-                // Both foreground and background colors
-                // For simplicity, using the same color for both
-                fcolor = parse_color(color_value, rgb_cube);
-                bcolor = parse_color(color_value, rgb_cube);
+
+            const auto [stripped, ok] = color_detail::strip_color(text);
+            on_segment(ColorSegment{stripped, ok ? color_escape(fcolor, bcolor) : ColorEscape{}, text.empty()});
+        }
+    }
+
+    // Parses str on every call, for specs only known at run time. The result is the only allocation
+    inline std::string format_color(const std::string_view str) {
+        std::string ret;
+        ret.reserve(str.size() + 16);
+        for_each_color_segment(str, [&ret](const ColorSegment& segment) {
+            if (segment.escape.size == 0) {
+                ret.append(segment.text);
+            } else {
+                ret.append(segment.escape.view()).append(segment.text).append(color_reset);
             }
-            else {
-                // Unknown color type; treat as normal text
-                ret += "{" + inside + "}";
-                pos = end + 1;
-                continue;
+        });
+        return ret;
+    }
+
+    // Spec as a template argument, see color_format
+    template<size_t N>
+    struct ColorLiteral {
+        char chars[N] = {};
+
+        consteval ColorLiteral(const char (&str)[N]) {
+            for (size_t i = 0; i < N; i++) {
+                chars[i] = str[i];
             }
+        }
+
+        [[nodiscard]] constexpr std::string_view view() const { return {chars, N - 1}; }
+    };
 
-            // Apply color formatting using color_string
-            std::string colored_text = color_string(text, fcolor, bcolor);
+    // A spec split into its segments ahead of time. format_to only copies the text and the precomputed
+    // escapes, plus one fmt::format_to per slot, so it never allocates
+    template<size_t Segments, size_t Slots>
+    struct ColorFormat {
+        std::array<ColorSegment, Segments> segments{};
+
+        // Renders the spec with args filling the slots in order, returns the end of the output like fmt::format_to
+        template<typename OutputIt, typename... Args>
+        OutputIt format_to(OutputIt out, const Args&... args) const {
+            static_assert(sizeof...(Args) == Slots, "Pass one argument per empty {:type color} slot");
+            size_t slot = 0;
+            // Compiled "{}" appends a whole view at once to buffers behind a back_inserter, where std::copy
+            // would push every character on its own
+            for (const ColorSegment& segment : segments) {
+                if (segment.escape.size != 0) {
+                    out = fmt::format_to(out, FMT_COMPILE("{}"), segment.escape.view());
+                }
+                if (segment.slot) {
+                    out = format_arg(out, slot++, std::index_sequence_for<Args...>{}, args...);
+                } else {
+                    out = fmt::format_to(out, FMT_COMPILE("{}"), segment.text);
+                }
+                if (segment.escape.size != 0) {
+                    out = fmt::format_to(out, FMT_COMPILE("{}"), color_reset);
+                }
+            }
+            return out;
+        }
 
-            // Append the colored text to the result
-            ret += colored_text;
+        template<typename... Args>
+        [[nodiscard]] std::string format(const Args&... args) const {
+            std::string ret;
+            format_to(std::back_inserter(ret), args...);
+            return ret;
+        }
 
-            // Move the position past the '}'
-            pos = end + 1;
+    private:
+        template<typename OutputIt, size_t... I, typename... Args>
+        static OutputIt format_arg(OutputIt out, const size_t index, std::index_sequence<I...>, const Args&... args) {
+            ((index == I ? (out = fmt::format_to(out, FMT_COMPILE("{}"), args), true) : false) || ...);
+            return out;
         }
+    };
 
-        return ret;
+    namespace color_detail {
+        template<ColorLiteral Spec>
+        consteval auto compile_color() {
+            constexpr std::string_view spec = Spec.view();
+            constexpr auto counts = [] {
+                std::pair<size_t, size_t> n{};
+                for_each_color_segment(spec, [&n](const ColorSegment& segment) {
+                    n.first++;
+                    n.second += segment.slot;
+                });
+                return n;
+            }();
+
+            ColorFormat<counts.first, counts.second> compiled;
+            size_t i = 0;
+            for_each_color_segment(spec, [&](const ColorSegment& segment) { compiled.segments[i++] = segment; });
+            return compiled;
+        }
     }
+
+    // Spec compiled at compile time, e.g. color_format<"[{:f cyan}] done\n">.format_to(out, count). Same syntax
+    // as format_color, except that a coloured segment without text is a slot for the next argument
+    template<ColorLiteral Spec>
+    inline constexpr auto color_format = color_detail::compile_color<Spec>();
  }
 
 #endif //COLOR_TOOLS_H
@@ -0,0 +1,95 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "cpu_info.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace salad {
+    namespace {
+        // First line of a sysfs file without the newline, empty if it can't be read
+        std::string read_line(const std::string& path) {
+            std::FILE* file = std::fopen(path.c_str(), "r");
+            if (file == nullptr) {
+                return {};
+            }
+            char buffer[64] = {};
+            if (std::fgets(buffer, sizeof(buffer), file) == nullptr) {
+                buffer[0] = '\0';
+            }
+            std::fclose(file);
+            buffer[std::strcspn(buffer, "\n")] = '\0';
+            return buffer;
+        }
+
+        // Sizes look like "48K" or "2M"
+        size_t parse_size(const std::string& text) {
+            size_t value = 0;
+            size_t i = 0;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++) {
+                value = value * 10 + (text[i] - '0');
+            }
+            if (i < text.size()) {
+                switch (text[i]) {
+                    case 'K': value <<= 10; break;
+                    case 'M': value <<= 20; break;
+                    case 'G': value <<= 30; break;
+                    default: break;
+                }
+            }
+            return value;
+        }
+
+        CacheInfo detect() {
+            CacheInfo info;
+            bool found = false;
+            for (int index = 0; ; index++) {
+                const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+                const std::string level = read_line(dir + "level");
+                if (level.empty()) {
+                    break;
+                }
+                const std::string type = read_line(dir + "type");
+                const size_t size = parse_size(read_line(dir + "size"));
+                if (type == "Instruction" || size == 0) {
+                    continue;
+                }
+
+                found = true;
+                if (level == "1") {
+                    info.l1d = size;
+                    const size_t line = parse_size(read_line(dir + "coherency_line_size"));
+                    info.line = line != 0 ? line : info.line;
+                } else if (level == "2") {
+                    info.l2 = size;
+                } else if (level == "3") {
+                    info.l3 = size;
+                }
+            }
+
+            if (!found) {
+                // No sysfs (containers sometimes hide it), glibc knows the sizes from cpuid
+                const long l1d = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+                const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+                const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+                const long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+                info.l1d = l1d > 0 ? l1d : info.l1d;
+                info.l2 = l2 > 0 ? l2 : info.l2;
+                info.l3 = l3 > 0 ? l3 : info.l3;
+                info.line = line > 0 ? line : info.line;
+            }
+            return info;
+        }
+    }
+
+    const CacheInfo& cache_info() {
+        static const CacheInfo info = detect();
+        return info;
+    }
+}
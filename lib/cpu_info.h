@@ -0,0 +1,24 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef CPU_INFO_H
+#define CPU_INFO_H
+#include <cstddef> // size_t and some other types
+
+namespace salad {
+    // Data cache sizes in bytes, anything that can't be detected keeps these typical values
+    struct CacheInfo {
+        size_t l1d = 32 << 10;
+        size_t l2 = 1 << 20;
+        size_t l3 = 8 << 20;
+        size_t line = 64;
+    };
+
+    // Read from /sys/devices/system/cpu/cpu0/cache on the first call (falling back to sysconf)
+    const CacheInfo& cache_info();
+}
+
+#endif //CPU_INFO_H
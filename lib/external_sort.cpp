@@ -0,0 +1,345 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "external_sort.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+namespace salad {
+    namespace {
+        // Smallest read buffer a run gets. Runs are merged in groups small enough that every reader (and the
+        // writer of an intermediate merge) gets at least this much of the budget
+        constexpr size_t min_run_buffer = 1 << 10;
+
+        // Descriptors left to the rest of the process when the open file limit caps a merge, and runs merged
+        // at once however small the budget is
+        constexpr size_t reserved_fds = 32;
+        constexpr size_t min_fan_in = 2;
+
+        // Runs one merge can read at once. The other sorter's merge may hold as many descriptors meanwhile
+        size_t max_fan_in(const size_t buffer) {
+            size_t fan_in = buffer / min_run_buffer;
+            rlimit limit{};
+            if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+                const size_t fds = static_cast<size_t>(limit.rlim_cur);
+                fan_in = std::min(fan_in, fds > reserved_fds ? (fds - reserved_fds) / 2 : 0);
+            }
+            // One of them is the output while a group is merged into a new run
+            return std::max(fan_in, min_fan_in + 1) - 1;
+        }
+
+        bool write_all(const int fd, const void* data, size_t size) {
+            const char* p = static_cast<const char*>(data);
+            while (size > 0) {
+                const ssize_t written = ::write(fd, p, size);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                p += written;
+                size -= written;
+            }
+            return true;
+        }
+    }
+
+    RunReader::RunReader(const int fd, const size_t buffer_size)
+        : fd(fd), buffer(buffer_size, uninitialized) {}
+
+    RunReader::RunReader(RunReader&& other) noexcept
+        : fd(std::exchange(other.fd, -1)), buffer(std::move(other.buffer)), pos(other.pos), end(other.end),
+          error(other.error) {}
+
+    RunReader::~RunReader() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool RunReader::refill() {
+        if (fd < 0 || error != 0) {
+            return false;
+        }
+
+        // Runs only hold whole values, but a read can still stop in the middle of one
+        size_t bytes = 0;
+        char* data = reinterpret_cast<char*>(buffer.data);
+        const size_t capacity = buffer.size * sizeof(uint32_t);
+        while (bytes == 0 || bytes % sizeof(uint32_t) != 0) {
+            const ssize_t got = ::read(fd, data + bytes, capacity - bytes);
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = errno;
+                return false;
+            }
+            if (got == 0) {
+                if (bytes % sizeof(uint32_t) != 0) {
+                    error = EIO;
+                }
+                break;
+            }
+            bytes += got;
+        }
+
+        pos = 0;
+        end = bytes / sizeof(uint32_t);
+        return end > 0;
+    }
+
+    LoserTree::LoserTree(std::vector<RunReader> runs)
+        : sources(std::move(runs)), heads(sources.size()), live(sources.size()), losers(sources.size()) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            live[i] = sources[i].next(heads[i]);
+        }
+        if (!sources.empty()) {
+            losers[0] = sources.size() == 1 ? 0 : play(1);
+        }
+    }
+
+    bool LoserTree::beats(const size_t a, const size_t b) const {
+        if (!live[a]) {
+            return false;
+        }
+        if (!live[b]) {
+            return true;
+        }
+        // Ties go to the earlier run
+        return heads[a] < heads[b] || (heads[a] == heads[b] && a < b);
+    }
+
+    // Plays the subtree under node (leaves are k..2k-1), stores every loser and returns the winner
+    size_t LoserTree::play(const size_t node) {
+        const size_t k = sources.size();
+        if (node >= k) {
+            return node - k;
+        }
+
+        const size_t left = play(node * 2);
+        const size_t right = play(node * 2 + 1);
+        const bool left_wins = beats(left, right);
+        losers[node] = left_wins ? right : left;
+        return left_wins ? left : right;
+    }
+
+    bool LoserTree::next(uint32_t& value) {
+        if (sources.empty()) {
+            return false;
+        }
+
+        size_t winner = losers[0];
+        if (!live[winner]) {
+            return false;
+        }
+        value = heads[winner];
+        live[winner] = sources[winner].next(heads[winner]);
+
+        // Only the matches on the winner's path can change, and each is against the loser stored there
+        for (size_t node = (winner + sources.size()) / 2; node >= 1; node /= 2) {
+            if (beats(losers[node], winner)) {
+                std::swap(losers[node], winner);
+            }
+        }
+        losers[0] = winner;
+        return true;
+    }
+
+    bool LoserTree::failed() const {
+        for (const RunReader& source : sources) {
+            if (source.failed()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ExternalSorter::ExternalSorter(const size_t budget, const SortFn sort, std::string tmp_dir)
+        : sort(sort), tmp_dir(std::move(tmp_dir)), chunk_size(std::max<size_t>(budget / sizeof(uint32_t), 1)),
+          chunk(chunk_size, uninitialized) {}
+
+    ExternalSorter::~ExternalSorter() {
+        for (const std::string& path : run_paths) {
+            ::unlink(path.c_str());
+        }
+        if (!dir.empty()) {
+            ::rmdir(dir.c_str());
+        }
+    }
+
+    ArrayView<uint32_t> ExternalSorter::reserve(const size_t count) {
+        if (used + count > chunk_size && used > 0) {
+            spill();
+        }
+        return chunk[{used, used + count}];
+    }
+
+    void ExternalSorter::commit(const size_t count) {
+        used += count;
+        total += count;
+    }
+
+    bool ExternalSorter::spill() {
+        Array<uint32_t> values = Array<uint32_t>(chunk.data, used, false);
+        sort(values);
+        used = 0;
+        if (io_error != 0) {
+            return false;
+        }
+
+        std::string path;
+        const int fd = create_run(path);
+        if (fd < 0) {
+            return false;
+        }
+        run_paths.push_back(std::move(path));
+
+        const bool written = write_all(fd, values.data, values.size * sizeof(uint32_t));
+        if (!written) {
+            io_error = errno;
+        }
+        ::close(fd);
+        return written;
+    }
+
+    int ExternalSorter::create_run(std::string& path) {
+        if (dir.empty()) {
+            std::string base = tmp_dir;
+            if (base.empty()) {
+                const char* env = std::getenv("TMPDIR");
+                base = env != nullptr && *env != '\0' ? env : "/tmp";
+            }
+            std::string temp = base + "/salad-sort-XXXXXX";
+            if (mkdtemp(temp.data()) == nullptr) {
+                io_error = errno;
+                return -1;
+            }
+            dir = std::move(temp);
+        }
+
+        path = dir + "/run-" + std::to_string(runs_created++) + ".bin";
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            io_error = errno;
+            path.clear();
+        }
+        return fd;
+    }
+
+    void ExternalSorter::finish() {
+        if (run_paths.empty()) {
+            // Everything fit, the sorted chunk is streamed straight from memory
+            Array<uint32_t> values = Array<uint32_t>(chunk.data, used, false);
+            sort(values);
+            return;
+        }
+        if (used > 0) {
+            spill();
+        }
+        chunk = Array<uint32_t>(nullptr, 0, false);
+    }
+
+    bool ExternalSorter::merge_group(const size_t first, const size_t count, const size_t per_run,
+                                     std::string& path) {
+        std::vector<RunReader> readers;
+        readers.reserve(count);
+        for (size_t i = first; i < first + count; i++) {
+            const int fd = ::open(run_paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                io_error = errno;
+                return false;
+            }
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            readers.emplace_back(fd, per_run);
+        }
+        LoserTree merge(std::move(readers));
+
+        const int fd = create_run(path);
+        if (fd < 0) {
+            return false;
+        }
+        Array<uint32_t> out = Array<uint32_t>(per_run, uninitialized);
+        size_t filled = 0;
+        bool written = true;
+        for (uint32_t value; written && merge.next(value);) {
+            out[filled++] = value;
+            if (filled == out.size) {
+                written = write_all(fd, out.data, filled * sizeof(uint32_t));
+                filled = 0;
+            }
+        }
+        written = written && write_all(fd, out.data, filled * sizeof(uint32_t));
+        if (!written) {
+            io_error = errno;
+        } else if (merge.failed()) {
+            io_error = EIO;
+            written = false;
+        }
+        ::close(fd);
+        return written;
+    }
+
+    ExternalSorter::Stream ExternalSorter::stream(const size_t buffer) {
+        Stream s;
+        if (run_paths.empty()) {
+            s.memory = chunk[{0, used}];
+            return s;
+        }
+
+        // Every pass merges groups of fan_in runs into one, until a single merge can read all that are left.
+        // Merged runs are deleted right away, so the disk never holds much more than one copy of the values
+        const size_t fan_in = max_fan_in(buffer);
+        while (run_paths.size() > fan_in && io_error == 0) {
+            const size_t per_run = std::max(buffer / (fan_in + 1), min_run_buffer) / sizeof(uint32_t);
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < run_paths.size(); first += fan_in) {
+                const size_t count = std::min(fan_in, run_paths.size() - first);
+                std::string path;
+                const bool ok = count > 1 && io_error == 0 && merge_group(first, count, per_run, path);
+                if (!path.empty()) {
+                    merged.push_back(std::move(path));
+                }
+                // Inputs stay listed (for the destructor to clean up) unless they made it into a merged run
+                for (size_t i = first; i < first + count; i++) {
+                    if (ok) {
+                        ::unlink(run_paths[i].c_str());
+                    } else {
+                        merged.push_back(std::move(run_paths[i]));
+                    }
+                }
+            }
+            run_paths = std::move(merged);
+        }
+        if (io_error != 0) {
+            s.error = true;
+            return s;
+        }
+
+        const size_t per_run = std::max(buffer / run_paths.size(), min_run_buffer) / sizeof(uint32_t);
+        std::vector<RunReader> readers;
+        readers.reserve(run_paths.size());
+        for (const std::string& path : run_paths) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                io_error = errno;
+                s.error = true;
+                return s;
+            }
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            readers.emplace_back(fd, per_run);
+        }
+        s.merge.emplace(std::move(readers));
+        return s;
+    }
+}
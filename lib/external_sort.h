@@ -0,0 +1,145 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "arr_util.h"
+
+namespace salad {
+    // Sequential reader over one spilled run, refilled with read() into a fixed buffer
+    class RunReader {
+    public:
+        RunReader(int fd, size_t buffer_size);
+        RunReader(RunReader&& other) noexcept;
+        RunReader& operator=(RunReader&&) = delete;
+        ~RunReader();
+
+        // False once the run is exhausted (or reading failed, see failed())
+        bool next(uint32_t& value) {
+            if (pos == end && !refill()) {
+                return false;
+            }
+            value = buffer[pos++];
+            return true;
+        }
+
+        [[nodiscard]] bool failed() const { return error != 0; }
+
+    private:
+        bool refill();
+
+        int fd;
+        Array<uint32_t> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        int error = 0;
+    };
+
+    // k-way merge over sorted sources with a tournament tree that keeps the loser of every match in its node.
+    // Replacing the winner only replays the matches on its leaf's path, log2(k) comparisons against the
+    // stored losers without looking at the siblings, so the root always holds the smallest head
+    class LoserTree {
+    public:
+        explicit LoserTree(std::vector<RunReader> sources);
+
+        bool next(uint32_t& value);
+
+        [[nodiscard]] bool failed() const;
+
+    private:
+        // Does source a's head come before source b's, exhausted sources lose every match
+        [[nodiscard]] bool beats(size_t a, size_t b) const;
+        size_t play(size_t node);
+
+        std::vector<RunReader> sources;
+        std::vector<uint32_t> heads;
+        std::vector<bool> live;
+        std::vector<size_t> losers;   // losers[0] is the overall winner, leaf i sits at node k + i
+    };
+
+    // Sorts more values than fit in memory: values are collected into a chunk of at most budget bytes, every
+    // full chunk is sorted with sort and spilled as a binary run into a private temporary directory, and
+    // the sorted result is streamed back with a k-way merge of the runs. While everything fits in one chunk
+    // nothing touches the disk. The sort engine gets its scratch on top of that (at most another chunk)
+    class ExternalSorter {
+    public:
+        using SortFn = Array<uint32_t>& (*)(Array<uint32_t>&);
+
+        // The temporary directory is created in tmp_dir, or $TMPDIR (/tmp if that's unset) when it's empty
+        ExternalSorter(size_t budget, SortFn sort, std::string tmp_dir = {});
+        ExternalSorter(const ExternalSorter&) = delete;
+        ExternalSorter& operator=(const ExternalSorter&) = delete;
+        ~ExternalSorter();
+
+        // Room for count more values, spills the current chunk first if it's needed. count must be at most
+        // capacity(), the view is cut short otherwise.
+        // Write into the returned view and pass the number of values actually written to commit
+        ArrayView<uint32_t> reserve(size_t count);
+        void commit(size_t count);
+
+        // Sorts the last chunk, spilling it too if there are other runs already. Frees the chunk after that
+        void finish();
+
+        // Sorted values, merged from the runs with buffer bytes split between their readers. More runs than
+        // the buffer (or the open file limit) can take at once are merged into fewer, longer ones first, a
+        // group at a time. Each call starts over from the beginning
+        class Stream {
+        public:
+            bool next(uint32_t& value) {
+                if (merge.has_value()) {
+                    return merge->next(value);
+                }
+                if (pos == memory.size) {
+                    return false;
+                }
+                value = memory[pos++];
+                return true;
+            }
+
+            [[nodiscard]] bool failed() const { return error || (merge.has_value() && merge->failed()); }
+
+        private:
+            friend class ExternalSorter;
+            std::optional<LoserTree> merge;
+            ArrayView<uint32_t> memory;
+            size_t pos = 0;
+            bool error = false;
+        };
+        Stream stream(size_t buffer);
+
+        [[nodiscard]] size_t capacity() const { return chunk_size; }
+        [[nodiscard]] size_t size() const { return total; }
+        [[nodiscard]] size_t runs() const { return run_paths.size(); }
+        [[nodiscard]] const std::string& directory() const { return dir; }
+        // The first I/O error (an errno value), 0 if there was none
+        [[nodiscard]] int error() const { return io_error; }
+
+    private:
+        bool spill();
+        // New run file in the temporary directory (created on first use), its path goes into path
+        int create_run(std::string& path);
+        // Merges run_paths[first, first + count) into a new run, path is set as soon as the file exists
+        bool merge_group(size_t first, size_t count, size_t per_run, std::string& path);
+
+        SortFn sort;
+        std::string tmp_dir;
+        std::string dir;
+        size_t chunk_size;
+        Array<uint32_t> chunk;
+        size_t used = 0;
+        size_t total = 0;
+        std::vector<std::string> run_paths;
+        size_t runs_created = 0;    // Names the run files, merged runs included
+        int io_error = 0;
+    };
+}
+
+#endif //EXTERNAL_SORT_H
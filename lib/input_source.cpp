@@ -0,0 +1,135 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "input_source.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace salad {
+    InputSource::InputSource(InputSource&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)),
+          mapped(std::exchange(other.mapped, false)), capacity(std::exchange(other.capacity, 0)),
+          opened(std::exchange(other.opened, false)) {}
+
+    InputSource& InputSource::operator=(InputSource&& other) noexcept {
+        if (this != &other) {
+            close();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+            mapped = std::exchange(other.mapped, false);
+            capacity = std::exchange(other.capacity, 0);
+            opened = std::exchange(other.opened, false);
+        }
+        return *this;
+    }
+
+    InputSource::~InputSource() {
+        close();
+    }
+
+    bool InputSource::open(const char* path) {
+        close();
+
+        const bool use_stdin = path == nullptr || std::strcmp(path, "-") == 0;
+        const int fd = use_stdin ? STDIN_FILENO : ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st{};
+        bool ok;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            ok = map_file(fd, st.st_size);
+        } else {
+            ok = read_chunked(fd);
+        }
+
+        if (!use_stdin) {
+            ::close(fd);
+        }
+        opened = ok;
+        return ok;
+    }
+
+    void InputSource::close() {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), capacity);
+        }
+        data = nullptr;
+        size = 0;
+        capacity = 0;
+        mapped = false;
+        opened = false;
+    }
+
+    bool InputSource::map_file(const int fd, const size_t file_size) {
+        if (file_size == 0) {
+            // mmap refuses zero-length mappings, an empty file is still a valid (empty) input
+            return true;
+        }
+
+        void* map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            // Some special files claim to be regular but can't be mapped (procfs, ...)
+            return read_chunked(fd);
+        }
+        madvise(map, file_size, MADV_SEQUENTIAL);
+
+        data = static_cast<const char*>(map);
+        size = file_size;
+        capacity = file_size;
+        mapped = true;
+        return true;
+    }
+
+    bool InputSource::read_chunked(const int fd) {
+        size_t cap = chunk_size;
+        void* buffer = mmap(nullptr, cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffer == MAP_FAILED) {
+            return false;
+        }
+
+        size_t len = 0;
+        while (true) {
+            if (len == cap) {
+                // mremap moves the pages instead of copying them
+                void* grown = mremap(buffer, cap, cap * 2, MREMAP_MAYMOVE);
+                if (grown == MAP_FAILED) {
+                    munmap(buffer, cap);
+                    return false;
+                }
+                buffer = grown;
+                cap *= 2;
+            }
+
+            const size_t want = cap - len < chunk_size ? cap - len : chunk_size;
+            const ssize_t got = read(fd, static_cast<char*>(buffer) + len, want);
+            if (got == 0) {
+                break;
+            }
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                munmap(buffer, cap);
+                return false;
+            }
+            len += got;
+        }
+
+        data = static_cast<const char*>(buffer);
+        size = len;
+        capacity = cap;
+        mapped = false;
+        return true;
+    }
+}
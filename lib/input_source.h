@@ -0,0 +1,47 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+#include <cstddef> // size_t and some other types
+#include <string_view>
+
+namespace salad {
+    // Read-only view over a whole input file.
+    // Regular files are mmap'd (no copy, no stack usage), anything else (pipes, stdin, ...) is read
+    // in fixed-size chunks straight into an anonymous mapping that grows with mremap, so the bytes are
+    // only ever written once.
+    struct InputSource {
+        static constexpr size_t chunk_size = 1 << 20;
+
+        const char* data = nullptr;
+        size_t size = 0;
+        bool mapped = false;    // true if data is a file mapping, false if it's our own buffer
+
+        InputSource() = default;
+        InputSource(const InputSource&) = delete;
+        InputSource& operator=(const InputSource&) = delete;
+        InputSource(InputSource&& other) noexcept;
+        InputSource& operator=(InputSource&& other) noexcept;
+        ~InputSource();
+
+        // "-" (or nullptr) reads from stdin
+        bool open(const char* path);
+        void close();
+
+        [[nodiscard]] bool is_open() const { return opened; }
+        [[nodiscard]] std::string_view view() const { return {data, size}; }
+
+    private:
+        size_t capacity = 0;    // Size of the mapping backing data (may be larger than size)
+        bool opened = false;    // Empty inputs have no mapping, but are still open
+
+        bool map_file(int fd, size_t file_size);
+        bool read_chunked(int fd);
+    };
+}
+
+#endif //INPUT_SOURCE_H
@@ -0,0 +1,87 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "instrument.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+
+namespace salad::instrument {
+#if SALAD_INSTRUMENTATION
+    namespace {
+        struct Registry {
+            std::mutex mutex;
+            std::vector<detail::ThreadCounters*> threads;
+            // Totals of the threads that have exited
+            Snapshot retired{};
+        };
+
+        // Never destroyed, thread_local counters may still unregister during static destruction
+        Registry& registry() {
+            static auto* instance = new Registry();
+            return *instance;
+        }
+    }
+
+    detail::ThreadCounters::ThreadCounters() {
+        Registry& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.threads.push_back(this);
+    }
+
+    detail::ThreadCounters::~ThreadCounters() {
+        Registry& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (size_t i = 0; i < counter_count; i++) {
+            reg.retired[i] += values[i].load(std::memory_order_relaxed);
+        }
+        reg.threads.erase(std::find(reg.threads.begin(), reg.threads.end(), this));
+    }
+
+    Snapshot snapshot() {
+        Registry& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        Snapshot total = reg.retired;
+        for (const detail::ThreadCounters* thread : reg.threads) {
+            for (size_t i = 0; i < counter_count; i++) {
+                total[i] += thread->values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+    void reset() {
+        Registry& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.retired = {};
+        for (detail::ThreadCounters* thread : reg.threads) {
+            for (std::atomic<uint64_t>& value : thread->values) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+#else
+    Snapshot snapshot() {
+        return {};
+    }
+
+    void reset() {}
+#endif
+
+    uint64_t read(const Counter counter) {
+        return snapshot()[static_cast<size_t>(counter)];
+    }
+
+    std::string to_json(const Snapshot& values) {
+        std::string json = "{";
+        for (size_t i = 0; i < counter_count; i++) {
+            json += fmt::format("\"{}\": {}{}", counter_names[i], values[i], i + 1 < counter_count ? ", " : "}");
+        }
+        return json;
+    }
+}
@@ -0,0 +1,78 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+#include <array>
+#include <atomic>
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Set by the SALAD_INSTRUMENTATION CMake option, counting compiles to nothing when it's 0
+#ifndef SALAD_INSTRUMENTATION
+#define SALAD_INSTRUMENTATION 1
+#endif
+
+namespace salad::instrument {
+    enum class Counter : size_t {
+        bytes_copied,
+        allocations,
+        frees,
+        bytes_allocated,
+        comparisons,
+        moves,
+    };
+
+    inline constexpr std::string_view counter_names[] = {
+        "bytes_copied", "allocations", "frees", "bytes_allocated", "comparisons", "moves"
+    };
+    inline constexpr size_t counter_count = std::size(counter_names);
+
+    using Snapshot = std::array<uint64_t, counter_count>;
+
+#if SALAD_INSTRUMENTATION
+    namespace detail {
+        // Only ever written by its own thread, the atomics just make reads from other threads well defined
+        struct ThreadCounters {
+            std::array<std::atomic<uint64_t>, counter_count> values{};
+
+            ThreadCounters();
+            ~ThreadCounters();
+        };
+
+        inline thread_local ThreadCounters counters;
+    }
+
+    inline void add(const Counter counter, const uint64_t n) {
+        std::atomic<uint64_t>& value = detail::counters.values[static_cast<size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+#else
+    inline void add(Counter, uint64_t) {}
+#endif
+
+    // Sum of a counter over every thread, including the ones that already exited
+    uint64_t read(Counter counter);
+    Snapshot snapshot();
+    // Zeroes every counter, only exact while no other thread is counting
+    void reset();
+
+    // {"bytes_copied": ..., "allocations": ..., ...}
+    std::string to_json(const Snapshot& values);
+    inline std::string to_json() { return to_json(snapshot()); }
+
+    inline Snapshot difference(const Snapshot& after, const Snapshot& before) {
+        Snapshot diff{};
+        for (size_t i = 0; i < counter_count; i++) {
+            diff[i] = after[i] - before[i];
+        }
+        return diff;
+    }
+}
+
+#endif //INSTRUMENT_H
@@ -0,0 +1,250 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef INT_CONV_H
+#define INT_CONV_H
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace salad {
+    // Same contract as std::from_chars_result: ptr is one past the last character used, ec is errc{} on success
+    struct ParseResult {
+        const char* ptr;
+        std::errc ec;
+    };
+
+    // Same contract as std::to_chars_result: ptr is one past the last character written
+    struct FormatResult {
+        char* ptr;
+        std::errc ec;
+    };
+
+    // Characters needed to format any T in any base. Base 2 is the longest, the minimum of a signed type needs
+    // one more digit than its value bits and a sign
+    template<std::integral T>
+    inline constexpr size_t max_chars = std::numeric_limits<T>::digits + 2 * std::is_signed_v<T>;
+
+    namespace conv_detail {
+        // Digit value of every byte, 255 for bytes that aren't a digit in any base up to 36
+        inline constexpr std::array<uint8_t, 256> digit_values = [] {
+            std::array<uint8_t, 256> table{};
+            table.fill(255);
+            for (int c = 0; c < 10; c++) {
+                table['0' + c] = c;
+            }
+            for (int c = 0; c < 26; c++) {
+                table['a' + c] = 10 + c;
+                table['A' + c] = 10 + c;
+            }
+            return table;
+        }();
+
+        inline constexpr char digit_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+        // "00", "01", ..., "99" back to back, two digits are written per division
+        inline constexpr std::array<char, 200> digit_pairs = [] {
+            std::array<char, 200> table{};
+            for (int i = 0; i < 100; i++) {
+                table[i * 2] = static_cast<char>('0' + i / 10);
+                table[i * 2 + 1] = static_cast<char>('0' + i % 10);
+            }
+            return table;
+        }();
+
+        inline constexpr std::array<uint64_t, 20> powers_of_10 = [] {
+            std::array<uint64_t, 20> table{};
+            uint64_t power = 1;
+            for (uint64_t& p : table) {
+                p = power;
+                power *= 10;
+            }
+            return table;
+        }();
+
+        // 8 ASCII digits (most significant first, in memory order) to their value
+        inline uint32_t swar_parse8(uint64_t chunk) {
+            chunk -= 0x3030303030303030ULL;
+            chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+            chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+            chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+            return static_cast<uint32_t>(chunk);
+        }
+
+        // High bit of every byte of chunk that isn't '0' to '9'. The high bits are cleared first, so adding to
+        // the other 7 bits can't carry into the next byte
+        inline uint64_t swar_non_digits(const uint64_t chunk) {
+            constexpr uint64_t high_bits = 0x8080808080808080ULL;
+            const uint64_t low = chunk & ~high_bits;
+            const uint64_t above_nine = low + 0x4646464646464646ULL;     // Sets the high bit above '9'
+            const uint64_t from_zero = low + 0x5050505050505050ULL;      // Sets the high bit from '0' on
+            return (chunk | above_nine | ~from_zero) & high_bits;
+        }
+
+        // Accumulates the decimal digits at p. With 8 bytes to look at, a run of up to 8 digits is found and
+        // converted at once, shorter ones padded with leading zeros. Overflow of value is flagged but every
+        // digit is still consumed, the same as std::from_chars
+        inline const char* scan_decimal(const char* p, const char* last, uint64_t& value, bool& overflow) {
+            while (last - p >= 8) {
+                uint64_t chunk;
+                std::memcpy(&chunk, p, sizeof(chunk));
+                const uint64_t others = swar_non_digits(chunk);
+                if (others == 0) {
+                    overflow |= __builtin_mul_overflow(value, 100000000u, &value);
+                    overflow |= __builtin_add_overflow(value, swar_parse8(chunk), &value);
+                    p += 8;
+                    continue;
+                }
+
+                const unsigned length = __builtin_ctzll(others) / 8;
+                if (length != 0) {
+                    chunk = chunk << (8 * (8 - length)) | 0x3030303030303030ULL >> (8 * length);
+                    overflow |= __builtin_mul_overflow(value, powers_of_10[length], &value);
+                    overflow |= __builtin_add_overflow(value, swar_parse8(chunk), &value);
+                }
+                return p + length;
+            }
+
+            // Fewer than 8 bytes left, which is at most 7 more digits: below 10^12 they can't overflow
+            if (value < 1'000'000'000'000) {
+                for (unsigned digit; p != last && (digit = static_cast<unsigned char>(*p) - '0') < 10; p++) {
+                    value = value * 10 + digit;
+                }
+                return p;
+            }
+            for (unsigned digit; p != last && (digit = static_cast<unsigned char>(*p) - '0') < 10; p++) {
+                overflow |= __builtin_mul_overflow(value, 10u, &value);
+                overflow |= __builtin_add_overflow(value, digit, &value);
+            }
+            return p;
+        }
+
+        inline const char* scan_digits(const char* p, const char* last, const unsigned base, uint64_t& value,
+                                       bool& overflow) {
+            for (unsigned digit; p != last && (digit = digit_values[static_cast<unsigned char>(*p)]) < base; p++) {
+                overflow |= __builtin_mul_overflow(value, base, &value);
+                overflow |= __builtin_add_overflow(value, digit, &value);
+            }
+            return p;
+        }
+
+        inline size_t decimal_length(uint64_t value) {
+            // 0 has a digit too, setting the lowest bit never adds one
+            value |= 1;
+            // bit_width * log10(2), which is either exact or one too many
+            const size_t guess = (std::bit_width(value) * 1233) >> 12;
+            return guess + 1 - (value < powers_of_10[guess]);
+        }
+
+        inline size_t length(uint64_t value, const unsigned base) {
+            if (base == 10) {
+                return decimal_length(value);
+            }
+            size_t digits = 1;
+            while (value >= base) {
+                value /= base;
+                digits++;
+            }
+            return digits;
+        }
+
+        // Writes the digits of value so that the last one lands just before end
+        inline void write_digits(char* end, uint64_t value, const unsigned base) {
+            if (base == 10) {
+                while (value >= 100) {
+                    end -= 2;
+                    std::memcpy(end, digit_pairs.data() + value % 100 * 2, 2);
+                    value /= 100;
+                }
+                if (value >= 10) {
+                    std::memcpy(end - 2, digit_pairs.data() + value * 2, 2);
+                } else {
+                    end[-1] = static_cast<char>('0' + value);
+                }
+                return;
+            }
+            do {
+                *--end = digit_chars[value % base];
+                value /= base;
+            } while (value != 0);
+        }
+    }
+
+    // Parses an integer from the start of text, like std::from_chars: an optional '-' (signed types only),
+    // then digits of base (2 to 36, letters in either case). Stops at the first character that isn't a digit
+    // of base. Never throws and leaves value untouched on errors: invalid_argument if there are no digits (or
+    // base is out of range), result_out_of_range with ptr past all digits if they don't fit in T
+    template<std::integral T>
+    ParseResult parse_int (const std::string_view text, T& value, const unsigned base = 10) {
+        static_assert(!std::is_same_v<T, bool>, "bool isn't a number to parse");
+        using unsigned_t = std::make_unsigned_t<T>;
+        const char* first = text.data();
+        const char* last = first + text.size();
+        if (base < 2 || base > 36) {
+            return {first, std::errc::invalid_argument};
+        }
+
+        const char* p = first;
+        bool negative = false;
+        if constexpr (std::is_signed_v<T>) {
+            negative = p != last && *p == '-';
+            p += negative;
+        }
+
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        const char* digits = p;
+        p = base == 10 ? conv_detail::scan_decimal(p, last, magnitude, overflow)
+                       : conv_detail::scan_digits(p, last, base, magnitude, overflow);
+        if (p == digits) {
+            return {first, std::errc::invalid_argument};
+        }
+
+        // A negative value may go one past the positive maximum
+        const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + negative;
+        if (overflow || magnitude > limit) {
+            return {p, std::errc::result_out_of_range};
+        }
+        value = static_cast<T>(negative ? static_cast<unsigned_t>(0) - static_cast<unsigned_t>(magnitude)
+                                        : static_cast<unsigned_t>(magnitude));
+        return {p, std::errc{}};
+    }
+
+    // Formats value in base (2 to 36, upper case letters) into [first, last), like std::to_chars.
+    // No terminator is written. value_too_large (with ptr == last) if it doesn't fit, max_chars<T> always does
+    template<std::integral T>
+    FormatResult format_int (char* first, char* last, const T value, const unsigned base = 10) {
+        static_assert(!std::is_same_v<T, bool>, "bool isn't a number to format");
+        using unsigned_t = std::make_unsigned_t<T>;
+        if (base < 2 || base > 36) {
+            return {first, std::errc::invalid_argument};
+        }
+
+        const bool negative = value < 0;
+        const uint64_t magnitude = negative ? static_cast<unsigned_t>(static_cast<unsigned_t>(0) - static_cast<unsigned_t>(value))
+                                            : static_cast<unsigned_t>(value);
+
+        // The exact length is known up front, so the digits go straight to their place without a reversal
+        const size_t length = negative + conv_detail::length(magnitude, base);
+        if (static_cast<size_t>(last - first) < length) {
+            return {last, std::errc::value_too_large};
+        }
+        if (negative) {
+            *first = '-';
+        }
+        conv_detail::write_digits(first + length, magnitude, base);
+        return {first + length, std::errc{}};
+    }
+}
+
+#endif //INT_CONV_H
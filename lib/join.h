@@ -0,0 +1,112 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef JOIN_H
+#define JOIN_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <type_traits>
+#include "arr_util.h"
+
+namespace salad {
+    // Walks two ascending arrays once and calls on_match(value, count_in_a, count_in_b) for every value that
+    // occurs in both. Runs of equal values are counted on each side, so every element is read exactly once.
+    template<typename T, typename F>
+    void merge_join (const ArrayView<T> a, const ArrayView<T> b, F&& on_match) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size && j < b.size) {
+            const T l = a[i];
+            const T r = b[j];
+            if (l < r) {
+                i++;
+            } else if (r < l) {
+                j++;
+            } else {
+                const size_t a_start = i;
+                const size_t b_start = j;
+                while (i < a.size && a[i] == l) {
+                    i++;
+                }
+                while (j < b.size && b[j] == l) {
+                    j++;
+                }
+                on_match(l, i - a_start, j - b_start);
+            }
+        }
+    }
+
+    // Sum over every x in a of x * (occurrences of x in b), both sorted ascending
+    template<typename T, typename Acc = uint64_t>
+    Acc similarity_join (const ArrayView<T> a, const ArrayView<T> b) {
+        Acc similarity = 0;
+        merge_join(a, b, [&similarity](const T value, const size_t count_a, const size_t count_b) {
+            similarity += static_cast<Acc>(value) * count_a * count_b;
+        });
+        return similarity;
+    }
+
+    // Same score as similarity_join without sorting either side. b is histogrammed into a counting array
+    // when its values span a small enough range, and into an open addressing hash table otherwise.
+    template<typename T, typename Acc = uint64_t>
+    Acc similarity_histogram (const ArrayView<T> a, const ArrayView<T> b) {
+        static_assert(std::is_integral_v<T>, "similarity_histogram only counts integers");
+        using key_t = std::make_unsigned_t<T>;
+        if (a.size == 0 || b.size == 0) {
+            return 0;
+        }
+
+        T min = b[0];
+        T max = b[0];
+        for (const T x : b) {
+            min = x < min ? x : min;
+            max = x > max ? x : max;
+        }
+
+        Acc similarity = 0;
+        const uint64_t range = static_cast<uint64_t>(static_cast<key_t>(max) - static_cast<key_t>(min)) + 1;
+        if (range <= (b.size < (1 << 20) ? (1 << 20) : b.size) * 4) {
+            Array<uint32_t> counts = Array<uint32_t>(range);
+            for (const T x : b) {
+                counts[static_cast<key_t>(x) - static_cast<key_t>(min)]++;
+            }
+            for (const T x : a) {
+                if (x >= min && x <= max) {
+                    similarity += static_cast<Acc>(x) * counts[static_cast<key_t>(x) - static_cast<key_t>(min)];
+                }
+            }
+            return similarity;
+        }
+
+        // Power of two table at most half full, linear probing on a multiplicative hash
+        size_t capacity = 16;
+        while (capacity < b.size * 2) {
+            capacity *= 2;
+        }
+        const size_t mask = capacity - 1;
+        Array<key_t> keys = Array<key_t>(capacity, uninitialized);
+        Array<uint32_t> counts = Array<uint32_t>(capacity);
+        auto slot_of = [&](const key_t key) {
+            size_t slot = static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+            while (counts[slot] != 0 && keys[slot] != key) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        };
+
+        for (const T x : b) {
+            const size_t slot = slot_of(static_cast<key_t>(x));
+            keys[slot] = static_cast<key_t>(x);
+            counts[slot]++;
+        }
+        for (const T x : a) {
+            similarity += static_cast<Acc>(x) * counts[slot_of(static_cast<key_t>(x))];
+        }
+        return similarity;
+    }
+}
+
+#endif //JOIN_H
@@ -0,0 +1,200 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "memory.h"
+
+#include <bit>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+
+namespace salad {
+    ArenaResource::ArenaResource(const size_t block_size, std::pmr::memory_resource* upstream)
+        : upstream(upstream), block_size(block_size) {}
+
+    ArenaResource::~ArenaResource() {
+        free_blocks(blocks);
+    }
+
+    void ArenaResource::free_blocks(Block* block) {
+        while (block != nullptr) {
+            Block* next = block->next;
+            upstream->deallocate(block, block->size, alignof(std::max_align_t));
+            block = next;
+        }
+    }
+
+    void ArenaResource::release() {
+        used_bytes = 0;
+        if (blocks != nullptr && blocks->size <= max_retained) {
+            // The newest block is the largest, the next run most likely fits in it again
+            free_blocks(blocks->next);
+            blocks->next = nullptr;
+            cursor = reinterpret_cast<char*>(blocks + 1);
+            end = reinterpret_cast<char*>(blocks) + blocks->size;
+            return;
+        }
+
+        free_blocks(blocks);
+        blocks = nullptr;
+        cursor = nullptr;
+        end = nullptr;
+    }
+
+    void* ArenaResource::do_allocate(const size_t bytes, const size_t alignment) {
+        auto align_up = [alignment](char* p) {
+            const auto addr = reinterpret_cast<uintptr_t>(p);
+            return reinterpret_cast<char*>((addr + alignment - 1) & ~(alignment - 1));
+        };
+
+        char* p = cursor != nullptr ? align_up(cursor) : nullptr;
+        if (p == nullptr || p + bytes > end) {
+            // Blocks grow with the arena so a long run doesn't end up with thousands of them
+            size_t size = blocks != nullptr ? blocks->size * 2 : block_size;
+            while (size < sizeof(Block) + bytes + alignment) {
+                size *= 2;
+            }
+
+            auto* block = static_cast<Block*>(upstream->allocate(size, alignof(std::max_align_t)));
+            block->next = blocks;
+            block->size = size;
+            blocks = block;
+            end = reinterpret_cast<char*>(block) + size;
+            p = align_up(reinterpret_cast<char*>(block + 1));
+        }
+
+        cursor = p + bytes;
+        used_bytes += bytes;
+        return p;
+    }
+
+    namespace {
+        // Size class index for a request, class_count if it's too large to pool
+        size_t size_class(const size_t bytes) {
+            const size_t rounded = std::bit_ceil(bytes < PoolResource::min_class ? PoolResource::min_class : bytes);
+            const size_t index = std::countr_zero(rounded) - std::countr_zero(PoolResource::min_class);
+            return index < PoolResource::class_count ? index : PoolResource::class_count;
+        }
+    }
+
+    PoolResource::PoolResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+    PoolResource::~PoolResource() {
+        release();
+    }
+
+    void PoolResource::release() {
+        std::lock_guard lock(mutex);
+        for (size_t c = 0; c < class_count; c++) {
+            for (void* p : free_lists[c]) {
+                upstream->deallocate(p, min_class << c, min_class);
+            }
+            free_lists[c].clear();
+        }
+    }
+
+    void* PoolResource::do_allocate(const size_t bytes, const size_t alignment) {
+        const size_t c = size_class(bytes);
+        if (c == class_count || alignment > min_class) {
+            return upstream->allocate(bytes, alignment);
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            if (!free_lists[c].empty()) {
+                void* p = free_lists[c].back();
+                free_lists[c].pop_back();
+                return p;
+            }
+        }
+        return upstream->allocate(min_class << c, min_class);
+    }
+
+    void PoolResource::do_deallocate(void* p, const size_t bytes, const size_t alignment) {
+        const size_t c = size_class(bytes);
+        if (c == class_count || alignment > min_class) {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        std::lock_guard lock(mutex);
+        free_lists[c].push_back(p);
+    }
+
+    void* AlignedResource::do_allocate(const size_t bytes, const size_t alignment) {
+        const size_t align = alignment > AlignedResource::alignment ? alignment : AlignedResource::alignment;
+        return ::operator new(bytes, std::align_val_t(align));
+    }
+
+    void AlignedResource::do_deallocate(void* p, const size_t bytes, const size_t alignment) {
+        const size_t align = alignment > AlignedResource::alignment ? alignment : AlignedResource::alignment;
+        ::operator delete(p, bytes, std::align_val_t(align));
+    }
+
+    namespace {
+        size_t huge_page_round(const size_t bytes) {
+            return (bytes + HugePageResource::page_size - 1) & ~(HugePageResource::page_size - 1);
+        }
+    }
+
+    void* HugePageResource::do_allocate(const size_t bytes, size_t) {
+        const size_t len = huge_page_round(bytes > 0 ? bytes : 1);
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+
+        // No reserved huge pages, ask for transparent ones instead
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        madvise(p, len, MADV_HUGEPAGE);
+        return p;
+    }
+
+    void HugePageResource::do_deallocate(void* p, const size_t bytes, size_t) {
+        munmap(p, huge_page_round(bytes > 0 ? bytes : 1));
+    }
+
+    std::pmr::memory_resource* aligned_resource() {
+        static AlignedResource resource;
+        return &resource;
+    }
+
+    std::pmr::memory_resource* huge_page_resource() {
+        static HugePageResource resource;
+        return &resource;
+    }
+
+    std::pmr::memory_resource* pool_resource() {
+        static PoolResource resource;
+        return &resource;
+    }
+
+    namespace {
+        thread_local size_t scratch_depth = 0;
+    }
+
+    ArenaResource& scratch_arena() {
+        thread_local ArenaResource arena;
+        return arena;
+    }
+
+    ScratchScope::ScratchScope() {
+        scratch_depth++;
+    }
+
+    ScratchScope::~ScratchScope() {
+        if (--scratch_depth == 0) {
+            scratch_arena().release();
+        }
+    }
+
+    bool ScratchScope::active() {
+        return scratch_depth > 0;
+    }
+}
@@ -0,0 +1,123 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <array>
+#include <cstddef> // size_t and some other types
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace salad {
+    // Bump allocator for per-run scratch: deallocate is a no-op and everything is freed at once by release().
+    // Once a block is used up the next, twice as large, comes from upstream. Not thread safe, use one arena
+    // per thread.
+    class ArenaResource : public std::pmr::memory_resource {
+    public:
+        // Largest block release() keeps around for the next run, bigger ones go back to upstream
+        static constexpr size_t max_retained = 64 << 20;
+
+        explicit ArenaResource(size_t block_size = 1 << 20,
+                               std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+        ArenaResource(const ArenaResource&) = delete;
+        ArenaResource& operator=(const ArenaResource&) = delete;
+        ~ArenaResource() override;
+
+        // Frees every allocation at once, the newest block is kept (up to max_retained) and reused
+        void release();
+        [[nodiscard]] size_t used() const { return used_bytes; }
+
+    private:
+        struct Block {
+            Block* next;
+            size_t size;
+        };
+
+        std::pmr::memory_resource* upstream;
+        size_t block_size;
+        Block* blocks = nullptr;
+        char* cursor = nullptr;
+        char* end = nullptr;
+        size_t used_bytes = 0;
+
+        void free_blocks(Block* block);
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Marks a stretch of code that takes sort scratch from scratch_arena(). The arena is released when the
+    // outermost scope on the thread ends, so scratch must not outlive the scope it was taken in.
+    class ScratchScope {
+    public:
+        ScratchScope();
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+        ~ScratchScope();
+
+        // Whether this thread is inside a scope
+        static bool active();
+    };
+
+    // Caches freed blocks in power-of-two size classes (64 B to 1 MiB), so the temporaries that sorts keep
+    // allocating and freeing are recycled instead of going back to the system. Larger blocks go to upstream.
+    class PoolResource : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t min_class = 64;
+        static constexpr size_t class_count = 15;  // 64 B << 14 = 1 MiB
+
+        explicit PoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+        PoolResource(const PoolResource&) = delete;
+        PoolResource& operator=(const PoolResource&) = delete;
+        ~PoolResource() override;
+
+        // Returns every cached block to upstream
+        void release();
+
+    private:
+        std::pmr::memory_resource* upstream;
+        std::mutex mutex;
+        std::array<std::vector<void*>, class_count> free_lists;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Cache line (and AVX-512 register) aligned blocks for SIMD kernels
+    class AlignedResource : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t alignment = 64;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Anonymous mappings rounded up to 2 MiB, backed by explicit huge pages (MAP_HUGETLB) when the system has
+    // some reserved and by transparent huge pages (MADV_HUGEPAGE) otherwise. Meant for multi-GB columns.
+    class HugePageResource : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t page_size = 2 << 20;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Process wide instances of the stateless resources
+    std::pmr::memory_resource* aligned_resource();
+    std::pmr::memory_resource* huge_page_resource();
+    // Process wide pool for small temporaries
+    std::pmr::memory_resource* pool_resource();
+    // This thread's arena for sort scratch, only allocate from it inside a ScratchScope
+    ArenaResource& scratch_arena();
+}
+
+#endif //MEMORY_H
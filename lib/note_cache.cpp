@@ -0,0 +1,226 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "note_cache.h"
+
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+namespace salad {
+    namespace {
+        constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+        constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+        inline uint64_t read64(const char* p) {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t read32(const char* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t round(uint64_t acc, const uint64_t input) {
+            acc += input * prime2;
+            return std::rotl(acc, 31) * prime1;
+        }
+
+        inline uint64_t merge_round(const uint64_t acc, const uint64_t lane) {
+            return (acc ^ round(0, lane)) * prime1 + prime4;
+        }
+
+        size_t align_up(const size_t offset) {
+            return (offset + NoteCache::column_alignment - 1) & ~(NoteCache::column_alignment - 1);
+        }
+
+        bool write_all(const int fd, iovec* parts, int count) {
+            while (count > 0) {
+                const ssize_t written = writev(fd, parts, count);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                // Skip whatever was written completely and trim the part that was cut short
+                size_t left = written;
+                while (count > 0 && left >= parts->iov_len) {
+                    left -= parts->iov_len;
+                    parts++;
+                    count--;
+                }
+                if (count > 0) {
+                    parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+                    parts->iov_len -= left;
+                }
+            }
+            return true;
+        }
+    }
+
+    uint64_t content_hash(const std::string_view data) {
+        const char* p = data.data();
+        const char* end = p + data.size();
+
+        uint64_t hash;
+        if (data.size() >= 32) {
+            uint64_t lanes[4] = {prime1 + prime2, prime2, 0, 0 - prime1};
+            for (; end - p >= 32; p += 32) {
+                for (int l = 0; l < 4; l++) {
+                    lanes[l] = round(lanes[l], read64(p + l * 8));
+                }
+            }
+            hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            for (const uint64_t lane : lanes) {
+                hash = merge_round(hash, lane);
+            }
+        } else {
+            hash = prime5;
+        }
+        hash += data.size();
+
+        for (; end - p >= 8; p += 8) {
+            hash = std::rotl(hash ^ round(0, read64(p)), 27) * prime1 + prime4;
+        }
+        if (end - p >= 4) {
+            hash = std::rotl(hash ^ read32(p) * prime1, 23) * prime2 + prime3;
+            p += 4;
+        }
+        for (; p != end; p++) {
+            hash = std::rotl(hash ^ static_cast<unsigned char>(*p) * prime5, 11) * prime1;
+        }
+
+        // Avalanche, so every input bit affects every output bit
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    NoteCache::~NoteCache() {
+        close();
+    }
+
+    void NoteCache::close() {
+        if (map != nullptr) {
+            munmap(map, map_size);
+        }
+        map = nullptr;
+        map_size = 0;
+        header = nullptr;
+    }
+
+    bool NoteCache::open(const char* path, const uint64_t hash, const size_t input_size) {
+        close();
+
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) < sizeof(NoteCacheHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        // Private and writable: sorting the columns in place copies the touched pages instead of writing back
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        map = static_cast<char*>(mapping);
+        map_size = st.st_size;
+        header = reinterpret_cast<const NoteCacheHeader*>(map);
+
+        const size_t column_bytes = header->count * sizeof(uint32_t);
+        const bool valid = std::memcmp(header->magic, NoteCacheHeader::magic_value, sizeof(header->magic)) == 0
+            && header->version == NoteCacheHeader::current_version
+            && header->input_size == input_size && header->hash == hash
+            && header->count <= map_size / sizeof(uint32_t)
+            && header->note1_offset % column_alignment == 0 && header->note2_offset % column_alignment == 0
+            && header->note1_offset >= sizeof(NoteCacheHeader) && header->note2_offset >= sizeof(NoteCacheHeader)
+            && header->note1_offset <= map_size - column_bytes && header->note2_offset <= map_size - column_bytes;
+        if (!valid) {
+            close();
+            return false;
+        }
+        madvise(map, map_size, MADV_WILLNEED);
+        return true;
+    }
+
+    Array<uint32_t> NoteCache::note1() const {
+        return Array<uint32_t>(reinterpret_cast<uint32_t*>(map + header->note1_offset), header->count, false);
+    }
+
+    Array<uint32_t> NoteCache::note2() const {
+        return Array<uint32_t>(reinterpret_cast<uint32_t*>(map + header->note2_offset), header->count, false);
+    }
+
+    size_t NoteCache::size() const {
+        return header != nullptr ? header->count : 0;
+    }
+
+    bool NoteCache::sorted() const {
+        return header != nullptr && (header->flags & NoteCacheHeader::sorted_flag) != 0;
+    }
+
+    bool NoteCache::write(const char* path, const uint64_t hash, const size_t input_size, const ArrayView<uint32_t> note1,
+                          const ArrayView<uint32_t> note2, const bool sorted) {
+        const size_t count = note1.size < note2.size ? note1.size : note2.size;
+        const size_t column_bytes = count * sizeof(uint32_t);
+
+        NoteCacheHeader header{};
+        std::memcpy(header.magic, NoteCacheHeader::magic_value, sizeof(header.magic));
+        header.version = NoteCacheHeader::current_version;
+        header.flags = sorted ? NoteCacheHeader::sorted_flag : 0;
+        header.hash = hash;
+        header.input_size = input_size;
+        header.count = count;
+        header.note1_offset = align_up(sizeof(NoteCacheHeader));
+        header.note2_offset = align_up(header.note1_offset + column_bytes);
+
+        static constexpr char padding[column_alignment] = {};
+        iovec parts[] = {
+            {&header, sizeof(header)},
+            {const_cast<char*>(padding), header.note1_offset - sizeof(header)},
+            {note1.data, column_bytes},
+            {const_cast<char*>(padding), header.note2_offset - header.note1_offset - column_bytes},
+            {note2.data, column_bytes},
+        };
+
+        std::string temp = std::string(path) + ".XXXXXX";
+        const int fd = mkstemp(temp.data());
+        if (fd < 0) {
+            return false;
+        }
+        // A crash can leave a short file behind, which open() rejects, so there's no need to wait for an fsync
+        const bool written = write_all(fd, parts, std::size(parts));
+        if (::close(fd) != 0 || !written || rename(temp.c_str(), path) != 0) {
+            unlink(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef NOTE_CACHE_H
+#define NOTE_CACHE_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <string_view>
+#include "arr_util.h"
+
+namespace salad {
+    // 64-bit hash of data, 32 bytes per step spread over four independent multiply-rotate lanes
+    // (the xxHash64 construction), so hashing runs at close to memory bandwidth
+    uint64_t content_hash(std::string_view data);
+
+    // On-disk layout of a cache file: this header, then both columns, each starting on a column_alignment
+    // boundary so they can be used straight from the mapping
+    struct NoteCacheHeader {
+        static constexpr char magic_value[8] = {'S', 'A', 'L', 'A', 'D', 'N', 'C', '\0'};
+        static constexpr uint32_t current_version = 1;
+        static constexpr uint32_t sorted_flag = 1;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t hash;          // content_hash of the input the columns were parsed from
+        uint64_t input_size;    // In bytes, checked before hashing anything
+        uint64_t count;         // Pairs in each column
+        uint64_t note1_offset;
+        uint64_t note2_offset;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(NoteCacheHeader) == 64);
+
+    // Parsed (and usually sorted) note columns saved next to a hash of the input they came from.
+    // The file is mapped copy-on-write, so unsorted columns can still be sorted in place without the file
+    // ever changing
+    class NoteCache {
+    public:
+        static constexpr size_t column_alignment = 64;
+
+        NoteCache() = default;
+        NoteCache(const NoteCache&) = delete;
+        NoteCache& operator=(const NoteCache&) = delete;
+        ~NoteCache();
+
+        // Maps path if it's a valid cache of an input of input_size bytes with that hash, false otherwise
+        // (no file, another input, a different version, truncated, ...)
+        bool open(const char* path, uint64_t hash, size_t input_size);
+        void close();
+
+        // Views into the mapping, valid until the cache is closed
+        [[nodiscard]] Array<uint32_t> note1() const;
+        [[nodiscard]] Array<uint32_t> note2() const;
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] bool sorted() const;
+
+        // Writes a cache of both columns (of the same size) to a temporary file next to path and renames it
+        // over path, so readers never see a partial file
+        static bool write(const char* path, uint64_t hash, size_t input_size, ArrayView<uint32_t> note1,
+                          ArrayView<uint32_t> note2, bool sorted);
+
+    private:
+        char* map = nullptr;
+        size_t map_size = 0;
+        const NoteCacheHeader* header = nullptr;
+    };
+}
+
+#endif //NOTE_CACHE_H
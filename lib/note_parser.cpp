@@ -0,0 +1,324 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "note_parser.h"
+#include "int_conv.h"
+
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+
+namespace salad {
+    namespace {
+        constexpr size_t block_size = 64;
+
+        // Chunks smaller than this aren't worth a task
+        constexpr size_t min_chunk_size = 256 << 10;
+
+        // Chunks per thread, so a thread that finishes early can still pick up work
+        constexpr size_t chunks_per_thread = 4;
+
+        // One bit per byte of a 64-byte block
+        struct BlockMasks {
+            uint64_t digits;
+            uint64_t newlines;
+        };
+
+        struct ScalarClassifier {
+            static BlockMasks classify(const char* block) {
+                uint64_t digits = 0;
+                uint64_t newlines = 0;
+                for (size_t i = 0; i < block_size; i++) {
+                    const auto c = static_cast<unsigned char>(block[i]);
+                    digits |= static_cast<uint64_t>(static_cast<unsigned char>(c - '0') < 10) << i;
+                    newlines |= static_cast<uint64_t>(c == '\n') << i;
+                }
+                return {digits, newlines};
+            }
+        };
+
+        struct SSE42Classifier {
+            [[gnu::target("sse4.2")]] static inline BlockMasks classify(const char* block) {
+                const __m128i zero = _mm_set1_epi8('0');
+                const __m128i nine = _mm_set1_epi8(9);
+                const __m128i newline = _mm_set1_epi8('\n');
+
+                uint64_t digits = 0;
+                uint64_t newlines = 0;
+                for (size_t i = 0; i < block_size; i += 16) {
+                    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+                    // c - '0' <= 9 (unsigned) <=> min(c - '0', 9) == c - '0'
+                    const __m128i shifted = _mm_sub_epi8(chars, zero);
+                    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine), shifted);
+                    const __m128i is_newline = _mm_cmpeq_epi8(chars, newline);
+                    digits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_digit))) << i;
+                    newlines |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_newline))) << i;
+                }
+                return {digits, newlines};
+            }
+        };
+
+        struct AVX2Classifier {
+            [[gnu::target("avx2")]] static inline BlockMasks classify(const char* block) {
+                const __m256i zero = _mm256_set1_epi8('0');
+                const __m256i nine = _mm256_set1_epi8(9);
+                const __m256i newline = _mm256_set1_epi8('\n');
+
+                const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+                const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+                const __m256i lo_shifted = _mm256_sub_epi8(lo, zero);
+                const __m256i hi_shifted = _mm256_sub_epi8(hi, zero);
+                const __m256i lo_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(lo_shifted, nine), lo_shifted);
+                const __m256i hi_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(hi_shifted, nine), hi_shifted);
+
+                const uint64_t digits = static_cast<uint32_t>(_mm256_movemask_epi8(lo_digit))
+                    | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hi_digit))) << 32;
+                const uint64_t newlines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)))
+                    | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)))) << 32;
+                return {digits, newlines};
+            }
+        };
+
+        using conv_detail::swar_parse8;
+
+        // Value of the digit run text[start:end], wrapping like uint32_t arithmetic on overflow
+        inline uint32_t parse_digits(const char* text, const size_t start, const size_t end) {
+            const size_t len = end - start;
+            if (end < 8) {
+                uint32_t value = 0;
+                for (size_t i = start; i < end; i++) {
+                    value = value * 10 + (text[i] - '0');
+                }
+                return value;
+            }
+
+            // Load the 8 bytes ending at the run and replace whatever precedes the run with leading zeros
+            uint64_t chunk;
+            std::memcpy(&chunk, text + end - 8, sizeof(chunk));
+            if (len >= 8) {
+                uint32_t prefix = 0;
+                for (size_t i = start; i < end - 8; i++) {
+                    prefix = prefix * 10 + (text[i] - '0');
+                }
+                return prefix * 100000000u + swar_parse8(chunk);
+            }
+
+            const uint64_t pad_mask = (1ULL << (8 * (8 - len))) - 1;
+            chunk = (chunk & ~pad_mask) | (0x3030303030303030ULL & pad_mask);
+            return swar_parse8(chunk);
+        }
+
+        template<typename Classifier>
+        inline size_t count_newlines(const std::string_view text) {
+            size_t count = 0;
+            size_t offset = 0;
+            for (; offset + block_size <= text.size(); offset += block_size) {
+                count += __builtin_popcountll(Classifier::classify(text.data() + offset).newlines);
+            }
+            for (; offset < text.size(); offset++) {
+                count += text[offset] == '\n';
+            }
+            return count;
+        }
+
+        // Finds the digit runs and newlines of 64 bytes at a time and only touches the bytes of the numbers
+        // themselves. Runs are converted with SWAR, so no byte is looked at more than twice.
+        template<typename Classifier>
+        inline size_t scan_notes(const std::string_view text, uint32_t* note1, uint32_t* note2,
+                                                        const size_t capacity) {
+            const char* data = text.data();
+            const size_t size = text.size();
+
+            size_t pairs = 0;
+            uint8_t column = 0;     // Numbers seen so far on the current line
+            size_t run_start = 0;   // Start of the most recent digit run
+            uint64_t carry = 0;     // 1 if the previous block ended inside a digit run
+
+            auto emit = [&](const size_t start, const size_t end) {
+                if (column < 2 && pairs < capacity) {
+                    (column == 0 ? note1 : note2)[pairs] = parse_digits(data, start, end);
+                }
+                column += column < 2;
+            };
+
+            alignas(block_size) char tail[block_size];
+            for (size_t offset = 0; offset < size; offset += block_size) {
+                const char* block = data + offset;
+                if (size - offset < block_size) {
+                    // Pad the last block with separators, which also terminates a trailing run
+                    std::memset(tail, ' ', block_size);
+                    std::memcpy(tail, block, size - offset);
+                    block = tail;
+                }
+
+                const auto [digits, newlines] = Classifier::classify(block);
+                const uint64_t starts = digits & ~(digits << 1 | carry);
+                // A run ends on the first non-digit after it
+                const uint64_t ends = ~digits & (digits << 1 | carry);
+
+                for (uint64_t events = ends | newlines; events != 0; events &= events - 1) {
+                    const uint64_t bit = events & -events;
+                    if (ends & bit) {
+                        // The run started at the last start before this end, or in an earlier block
+                        if (const uint64_t before = starts & (bit - 1)) {
+                            run_start = offset + 63 - __builtin_clzll(before);
+                        }
+                        emit(run_start, offset + __builtin_ctzll(bit));
+                    }
+                    if (newlines & bit) {
+                        pairs += column == 2;
+                        column = 0;
+                    }
+                }
+
+                carry = digits >> 63;
+                if (carry && starts != 0) {
+                    run_start = offset + 63 - __builtin_clzll(starts);
+                }
+            }
+
+            // Input ended exactly on a block boundary in the middle of a number
+            if (carry) {
+                emit(run_start, size);
+            }
+            // Last line without a trailing newline
+            pairs += column == 2;
+
+            return pairs < capacity ? pairs : capacity;
+        }
+
+        enum class SimdLevel { scalar, sse42, avx2 };
+
+        SimdLevel detect_simd() {
+            static const SimdLevel level = [] {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2")) {
+                    return SimdLevel::avx2;
+                }
+                if (__builtin_cpu_supports("sse4.2")) {
+                    return SimdLevel::sse42;
+                }
+                return SimdLevel::scalar;
+            }();
+            return level;
+        }
+
+        [[gnu::target("avx2"), gnu::flatten]] size_t count_newlines_avx2(const std::string_view text) {
+            return count_newlines<AVX2Classifier>(text);
+        }
+
+        [[gnu::target("sse4.2"), gnu::flatten]] size_t count_newlines_sse42(const std::string_view text) {
+            return count_newlines<SSE42Classifier>(text);
+        }
+
+        [[gnu::target("avx2"), gnu::flatten]] size_t scan_notes_avx2(const std::string_view text, uint32_t* note1, uint32_t* note2,
+                                                       const size_t capacity) {
+            return scan_notes<AVX2Classifier>(text, note1, note2, capacity);
+        }
+
+        [[gnu::target("sse4.2"), gnu::flatten]] size_t scan_notes_sse42(const std::string_view text, uint32_t* note1, uint32_t* note2,
+                                                          const size_t capacity) {
+            return scan_notes<SSE42Classifier>(text, note1, note2, capacity);
+        }
+    }
+
+    size_t count_lines(const std::string_view text) {
+        if (text.empty()) {
+            return 0;
+        }
+
+        size_t newlines;
+        switch (detect_simd()) {
+        case SimdLevel::avx2:
+            newlines = count_newlines_avx2(text);
+            break;
+        case SimdLevel::sse42:
+            newlines = count_newlines_sse42(text);
+            break;
+        default:
+            newlines = count_newlines<ScalarClassifier>(text);
+            break;
+        }
+        return newlines + (text.back() != '\n');
+    }
+
+    size_t parse_notes(const std::string_view text, Array<uint32_t>& note1, Array<uint32_t>& note2) {
+        const size_t capacity = note1.size < note2.size ? note1.size : note2.size;
+        switch (detect_simd()) {
+        case SimdLevel::avx2:
+            return scan_notes_avx2(text, note1.data, note2.data, capacity);
+        case SimdLevel::sse42:
+            return scan_notes_sse42(text, note1.data, note2.data, capacity);
+        default:
+            return scan_notes<ScalarClassifier>(text, note1.data, note2.data, capacity);
+        }
+    }
+
+    NoteLayout layout_notes(const std::string_view text, ThreadPool& pool) {
+        NoteLayout layout;
+        layout.text = text;
+
+        const size_t wanted = std::clamp<size_t>(text.size() / min_chunk_size, 1, pool.size() * chunks_per_thread);
+        const size_t stride = text.size() / wanted;
+        layout.bounds.push_back(0);
+        for (size_t i = 1; i < wanted; i++) {
+            // Move every cut just past the next newline, so no line is split between two chunks
+            const size_t from = std::max(i * stride, layout.bounds.back());
+            const void* newline = std::memchr(text.data() + from, '\n', text.size() - from);
+            if (newline == nullptr) {
+                break;
+            }
+            const size_t cut = static_cast<const char*>(newline) - text.data() + 1;
+            if (cut < text.size() && cut > layout.bounds.back()) {
+                layout.bounds.push_back(cut);
+            }
+        }
+        layout.bounds.push_back(text.size());
+
+        const size_t chunks = layout.chunks();
+        layout.offsets.assign(chunks + 1, 0);
+        pool.parallel_for(0, chunks, 1, [&](const size_t begin, const size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                layout.offsets[c + 1] = count_lines(text.substr(layout.bounds[c], layout.bounds[c + 1] - layout.bounds[c]));
+            }
+        });
+        for (size_t c = 0; c < chunks; c++) {
+            layout.offsets[c + 1] += layout.offsets[c];
+        }
+        return layout;
+    }
+
+    size_t parse_notes(const NoteLayout& layout, Array<uint32_t>& note1, Array<uint32_t>& note2, ThreadPool& pool) {
+        const size_t capacity = note1.size < note2.size ? note1.size : note2.size;
+        const size_t chunks = layout.chunks();
+
+        std::vector<size_t> parsed(chunks, 0);
+        pool.parallel_for(0, chunks, 1, [&](const size_t begin, const size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                const size_t offset = layout.offsets[c];
+                if (offset >= capacity) {
+                    continue;
+                }
+                const std::string_view chunk = layout.text.substr(layout.bounds[c], layout.bounds[c + 1] - layout.bounds[c]);
+                Array<uint32_t> slice1 = Array<uint32_t>(note1.data + offset, std::min(layout.offsets[c + 1], capacity) - offset, false);
+                Array<uint32_t> slice2 = Array<uint32_t>(note2.data + offset, slice1.size, false);
+                parsed[c] = parse_notes(chunk, slice1, slice2);
+            }
+        });
+
+        // Every slice was sized for all of its lines, blank or incomplete ones leave a gap at its end.
+        // Usually there are none and nothing moves
+        size_t pairs = parsed.empty() ? 0 : parsed[0];
+        for (size_t c = 1; c < chunks; c++) {
+            if (pairs != layout.offsets[c] && parsed[c] > 0) {
+                std::memmove(note1.data + pairs, note1.data + layout.offsets[c], parsed[c] * sizeof(uint32_t));
+                std::memmove(note2.data + pairs, note2.data + layout.offsets[c], parsed[c] * sizeof(uint32_t));
+            }
+            pairs += parsed[c];
+        }
+        return pairs;
+    }
+}
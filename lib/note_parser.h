@@ -0,0 +1,46 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef NOTE_PARSER_H
+#define NOTE_PARSER_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "arr_util.h"
+#include "thread_pool.h"
+
+namespace salad {
+    // Exact number of lines in text (a final line without '\n' counts as well)
+    size_t count_lines(std::string_view text);
+
+    // Parses two whitespace separated columns of unsigned integers, one pair per line.
+    // The first number on a line goes to note1 and the second to note2, extra numbers are ignored and lines
+    // with fewer than two numbers are skipped. At most min(note1.size, note2.size) pairs are written.
+    // Returns the number of pairs written.
+    size_t parse_notes(std::string_view text, Array<uint32_t>& note1, Array<uint32_t>& note2);
+
+    // text split into chunks that each end on a line boundary, with the lines before every chunk
+    struct NoteLayout {
+        std::string_view text;
+        std::vector<size_t> bounds;     // Chunk i is text[bounds[i]:bounds[i + 1]]
+        std::vector<size_t> offsets;    // Lines in all chunks before chunk i, the last one is the total
+        [[nodiscard]] size_t chunks() const { return bounds.size() - 1; }
+        [[nodiscard]] size_t lines() const { return offsets.back(); }
+    };
+
+    // Splits text into about one chunk per thread of pool (fewer for small inputs) and counts the lines of
+    // every chunk in parallel. Column arrays of layout.lines() elements hold every pair
+    NoteLayout layout_notes(std::string_view text, ThreadPool& pool);
+
+    // Parses every chunk of layout on pool, straight into its own slice of note1 and note2 (placed by the
+    // line offsets), then closes the gaps left by skipped lines. Columns are taken from the position of a
+    // number on its line, so as long as the columns hold layout.lines() elements the result is the same as
+    // parse_notes(layout.text, ...) at any thread count. Returns the number of pairs written.
+    size_t parse_notes(const NoteLayout& layout, Array<uint32_t>& note1, Array<uint32_t>& note2, ThreadPool& pool);
+}
+
+#endif //NOTE_PARSER_H
@@ -0,0 +1,71 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "output_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace salad {
+    OutputSink::OutputSink(const int fd, const Verbosity verbosity)
+        : fd(fd), level(verbosity), terminal(isatty(fd) == 1) {}
+
+    OutputSink::~OutputSink() {
+        flush();
+    }
+
+    OutputSink& OutputSink::out() {
+        static OutputSink sink(STDOUT_FILENO);
+        return sink;
+    }
+
+    void OutputSink::write(const Verbosity verbosity, const std::string_view text) {
+        if (!enabled(verbosity)) {
+            return;
+        }
+        if (text.size() < flush_threshold) {
+            buffer.append(text.data(), text.data() + text.size());
+            pending();
+            return;
+        }
+        write_all({buffer.data(), buffer.size()}, text);
+        buffer.clear();
+    }
+
+    bool OutputSink::flush() {
+        if (buffer.size() == 0) {
+            return !failed;
+        }
+        const bool written = write_all({buffer.data(), buffer.size()}, {});
+        buffer.clear();
+        return written;
+    }
+
+    bool OutputSink::write_all(std::string_view first, std::string_view second) {
+        while (!failed && (!first.empty() || !second.empty())) {
+            iovec parts[2] = {
+                {const_cast<char*>(first.data()), first.size()},
+                {const_cast<char*>(second.data()), second.size()},
+            };
+            const ssize_t written = first.empty() ? ::writev(fd, parts + 1, 1) : ::writev(fd, parts, 2);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed = true;
+                break;
+            }
+
+            size_t done = written;
+            const size_t from_first = std::min(done, first.size());
+            first.remove_prefix(from_first);
+            second.remove_prefix(done - from_first);
+        }
+        return !failed;
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <fmt/format.h>
+
+namespace salad {
+    // How much a run prints, every level includes the ones before it
+    enum class Verbosity : uint8_t {
+        quiet,      // The answers only
+        summary,    // Progress and the answers, but nothing per value
+        verbose,    // Everything, including a line per matched value
+    };
+
+    // Formats straight into one growing buffer and hands it to write(2) in large batches, instead of a
+    // stream flush (or at least a stream call) per line. Output to a terminal goes out at the end of every
+    // line so it still shows up as it's printed, everything else only once flush_threshold bytes are
+    // pending, on flush() or on destruction. Not thread safe, format on one thread
+    class OutputSink {
+    public:
+        static constexpr size_t flush_threshold = 1 << 16;
+
+        // fd stays owned by the caller
+        explicit OutputSink(int fd, Verbosity verbosity = Verbosity::verbose);
+        OutputSink(const OutputSink&) = delete;
+        OutputSink& operator=(const OutputSink&) = delete;
+        ~OutputSink();
+
+        // Sink for stdout, created on first use and flushed at exit
+        static OutputSink& out();
+
+        [[nodiscard]] Verbosity verbosity() const { return level; }
+        void set_verbosity(const Verbosity verbosity) { level = verbosity; }
+        [[nodiscard]] bool enabled(const Verbosity verbosity) const { return verbosity <= level; }
+        [[nodiscard]] bool is_terminal() const { return terminal; }
+
+        template<typename... Args>
+        void print(const Verbosity verbosity, fmt::format_string<Args...> format, Args&&... args) {
+            if (!enabled(verbosity)) {
+                return;
+            }
+            fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+            pending();
+        }
+
+        // Calls writer with an output iterator into the buffer, for anything that formats itself (like
+        // ColorFormat::format_to)
+        template<typename Writer>
+        void render(const Verbosity verbosity, Writer&& writer) {
+            if (!enabled(verbosity)) {
+                return;
+            }
+            writer(std::back_inserter(buffer));
+            pending();
+        }
+
+        // Large text goes out together with whatever is pending in one writev instead of being copied
+        void write(Verbosity verbosity, std::string_view text);
+
+        // Writes everything pending, false (with errno set) if the descriptor failed. Later output is dropped
+        // after a failure, the same as a stream in a bad state
+        bool flush();
+
+    private:
+        void pending() {
+            const bool line_done = buffer.size() > 0 && buffer.data()[buffer.size() - 1] == '\n';
+            if (buffer.size() >= flush_threshold || (terminal && line_done)) {
+                flush();
+            }
+        }
+
+        // Writes all of both parts, retrying short writes
+        bool write_all(std::string_view first, std::string_view second);
+
+        int fd;
+        Verbosity level;
+        bool terminal;
+        bool failed = false;
+        fmt::memory_buffer buffer;
+    };
+}
+
+#endif //OUTPUT_SINK_H
@@ -0,0 +1,121 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "reduce.h"
+
+#include <immintrin.h>
+
+namespace salad {
+    namespace {
+        // |a - b| as an unsigned 32-bit value, which always fits: max(a, b) - min(a, b)
+        template<bool Signed>
+        uint64_t abs_diff_scalar(const uint32_t* a, const uint32_t* b, const size_t n) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; i++) {
+                const bool less = Signed ? static_cast<int32_t>(a[i]) < static_cast<int32_t>(b[i]) : a[i] < b[i];
+                sum += less ? b[i] - a[i] : a[i] - b[i];
+            }
+            return sum;
+        }
+
+        template<bool Signed>
+        [[gnu::target("avx2")]] inline __m256i diff_avx2(const uint32_t* a, const uint32_t* b) {
+            const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+            const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+            return Signed ? _mm256_sub_epi32(_mm256_max_epi32(l, r), _mm256_min_epi32(l, r))
+                          : _mm256_sub_epi32(_mm256_max_epu32(l, r), _mm256_min_epu32(l, r));
+        }
+
+        template<bool Signed>
+        [[gnu::target("avx512f")]] inline __m512i diff_avx512(const uint32_t* a, const uint32_t* b) {
+            const __m512i l = _mm512_loadu_si512(a);
+            const __m512i r = _mm512_loadu_si512(b);
+            return Signed ? _mm512_sub_epi32(_mm512_max_epi32(l, r), _mm512_min_epi32(l, r))
+                          : _mm512_sub_epi32(_mm512_max_epu32(l, r), _mm512_min_epu32(l, r));
+        }
+
+        // Every 32-bit difference is split into its even and odd lanes and added to two 64-bit accumulators.
+        // Two independent sets of accumulators keep the adds of one iteration off the critical path of the next
+        template<bool Signed>
+        [[gnu::target("avx2")]] uint64_t abs_diff_avx2(const uint32_t* a, const uint32_t* b, const size_t n) {
+            constexpr size_t lanes = 8;
+            const __m256i low_half = _mm256_set1_epi64x(0xFFFFFFFF);
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+
+            size_t i = 0;
+            for (; i + 2 * lanes <= n; i += 2 * lanes) {
+                const __m256i d0 = diff_avx2<Signed>(a + i, b + i);
+                const __m256i d1 = diff_avx2<Signed>(a + i + lanes, b + i + lanes);
+                acc0 = _mm256_add_epi64(acc0, _mm256_and_si256(d0, low_half));
+                acc1 = _mm256_add_epi64(acc1, _mm256_srli_epi64(d0, 32));
+                acc0 = _mm256_add_epi64(acc0, _mm256_and_si256(d1, low_half));
+                acc1 = _mm256_add_epi64(acc1, _mm256_srli_epi64(d1, 32));
+            }
+
+            alignas(32) uint64_t lane_sums[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lane_sums), _mm256_add_epi64(acc0, acc1));
+            return lane_sums[0] + lane_sums[1] + lane_sums[2] + lane_sums[3]
+                + abs_diff_scalar<Signed>(a + i, b + i, n - i);
+        }
+
+        template<bool Signed>
+        [[gnu::target("avx512f")]] uint64_t abs_diff_avx512(const uint32_t* a, const uint32_t* b, const size_t n) {
+            constexpr size_t lanes = 16;
+            const __m512i low_half = _mm512_set1_epi64(0xFFFFFFFF);
+            __m512i acc0 = _mm512_setzero_si512();
+            __m512i acc1 = _mm512_setzero_si512();
+
+            size_t i = 0;
+            for (; i + 2 * lanes <= n; i += 2 * lanes) {
+                const __m512i d0 = diff_avx512<Signed>(a + i, b + i);
+                const __m512i d1 = diff_avx512<Signed>(a + i + lanes, b + i + lanes);
+                acc0 = _mm512_add_epi64(acc0, _mm512_and_si512(d0, low_half));
+                acc1 = _mm512_add_epi64(acc1, _mm512_srli_epi64(d0, 32));
+                acc0 = _mm512_add_epi64(acc0, _mm512_and_si512(d1, low_half));
+                acc1 = _mm512_add_epi64(acc1, _mm512_srli_epi64(d1, 32));
+            }
+
+            return _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1)) + abs_diff_scalar<Signed>(a + i, b + i, n - i);
+        }
+
+        enum class SimdLevel { none, avx2, avx512 };
+
+        SimdLevel detect_simd() {
+            static const SimdLevel level = [] {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) {
+                    return SimdLevel::avx512;
+                }
+                if (__builtin_cpu_supports("avx2")) {
+                    return SimdLevel::avx2;
+                }
+                return SimdLevel::none;
+            }();
+            return level;
+        }
+
+        template<bool Signed>
+        uint64_t dispatch(const uint32_t* a, const uint32_t* b, const size_t n) {
+            switch (detect_simd()) {
+            case SimdLevel::avx512:
+                return abs_diff_avx512<Signed>(a, b, n);
+            case SimdLevel::avx2:
+                return abs_diff_avx2<Signed>(a, b, n);
+            default:
+                return abs_diff_scalar<Signed>(a, b, n);
+            }
+        }
+    }
+
+    uint64_t abs_diff_sum(const uint32_t* a, const uint32_t* b, const size_t n) {
+        return dispatch<false>(a, b, n);
+    }
+
+    uint64_t abs_diff_sum(const int32_t* a, const int32_t* b, const size_t n) {
+        return dispatch<true>(reinterpret_cast<const uint32_t*>(a), reinterpret_cast<const uint32_t*>(b), n);
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef REDUCE_H
+#define REDUCE_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <vector>
+#include "arr_util.h"
+#include "thread_pool.h"
+
+namespace salad {
+    // Columns at least this long are split between the threads of a pool, shorter ones aren't worth waking them
+    inline constexpr size_t parallel_reduce_threshold = 1 << 20;
+
+    // Sum of |a[i] - b[i]| over the first n elements. The differences are widened into 64-bit lanes, so the sum
+    // can't overflow for any n that fits in memory. Runs on AVX-512 or AVX2 if the CPU has either
+    uint64_t abs_diff_sum(const uint32_t* a, const uint32_t* b, size_t n);
+    uint64_t abs_diff_sum(const int32_t* a, const int32_t* b, size_t n);
+
+    // Over the common length of a and b
+    template<typename T>
+    uint64_t abs_diff_sum (const ArrayView<T> a, const ArrayView<T> b) {
+        return abs_diff_sum(a.data, b.data, a.size < b.size ? a.size : b.size);
+    }
+
+    // Same, with long columns split into one range per thread of pool
+    template<typename T>
+    uint64_t abs_diff_sum (const ArrayView<T> a, const ArrayView<T> b, ThreadPool& pool) {
+        const size_t n = a.size < b.size ? a.size : b.size;
+        if (n < parallel_reduce_threshold || pool.size() < 2) {
+            return abs_diff_sum(a.data, b.data, n);
+        }
+
+        const size_t ranges = pool.size();
+        // Whole cache lines per range so no two threads share one
+        const size_t grain = ((n + ranges - 1) / ranges + 15) & ~size_t{15};
+        std::vector<uint64_t> partial(ranges, 0);
+        pool.parallel_for(0, n, grain, [&](const size_t begin, const size_t end) {
+            partial[begin / grain] = abs_diff_sum(a.data + begin, b.data + begin, end - begin);
+        });
+
+        uint64_t sum = 0;
+        for (const uint64_t p : partial) {
+            sum += p;
+        }
+        return sum;
+    }
+}
+
+#endif //REDUCE_H
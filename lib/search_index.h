@@ -0,0 +1,157 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+#include <bit>
+#include <cstddef> // size_t and some other types
+#include <limits>
+#include "arr_util.h"
+#include "memory.h"
+
+namespace salad {
+    // Queries interleaved per batch step, enough independent loads in flight to hide DRAM latency
+    inline constexpr size_t search_batch = 16;
+
+    // lower_bound without a data dependent branch: the loop length only depends on arr.size, the comparison
+    // result turns into a conditional move. Both possible next probes are prefetched.
+    template<typename T>
+    size_t branchless_lower_bound (const ArrayView<T> arr, const T val) {
+        if (arr.size == 0) {
+            return 0;
+        }
+
+        const T* base = arr.data;
+        size_t len = arr.size;
+        while (len > 1) {
+            const size_t half = len / 2;
+            __builtin_prefetch(base + (len - half) / 2);
+            __builtin_prefetch(base + half + (len - half) / 2);
+            base = base[half] < val ? base + half : base;
+            len -= half;
+        }
+        return (base - arr.data) + (*base < val);
+    }
+
+    // Every query walks the exact same number of steps, so a batch advances in lock-step and all of its loads
+    // of one step are independent of each other
+    template<typename T>
+    void branchless_lower_bound_batch (const ArrayView<T> arr, const ArrayView<T> queries, const ArrayView<size_t> out) {
+        if (arr.size == 0) {
+            for (size_t& o : out) {
+                o = 0;
+            }
+            return;
+        }
+
+        for (size_t q = 0; q < queries.size; q += search_batch) {
+            const size_t group = queries.size - q < search_batch ? queries.size - q : search_batch;
+            const T* bases[search_batch];
+            for (size_t g = 0; g < group; g++) {
+                bases[g] = arr.data;
+            }
+
+            size_t len = arr.size;
+            while (len > 1) {
+                const size_t half = len / 2;
+                for (size_t g = 0; g < group; g++) {
+                    __builtin_prefetch(bases[g] + (len - half) / 2);
+                    __builtin_prefetch(bases[g] + half + (len - half) / 2);
+                }
+                for (size_t g = 0; g < group; g++) {
+                    bases[g] = bases[g][half] < queries[q + g] ? bases[g] + half : bases[g];
+                }
+                len -= half;
+            }
+
+            for (size_t g = 0; g < group; g++) {
+                out[q + g] = (bases[g] - arr.data) + (*bases[g] < queries[q + g]);
+            }
+        }
+    }
+
+    // Sorted values in BFS (Eytzinger) order: node k has its children at 2k and 2k + 1, so the first levels
+    // of every search share the same few cache lines and the next 4 levels (for 32-bit keys) sit in one line
+    // that can be prefetched early. The tree is padded to a perfect one with max() values, which keeps every
+    // search the same length and makes batches lock-step like branchless_lower_bound_batch.
+    template<typename T>
+    class EytzingerIndex {
+    public:
+        explicit EytzingerIndex(const ArrayView<T> sorted)
+            : tree(std::bit_ceil(sorted.size + 1), uninitialized, aligned_resource()), count(sorted.size),
+              levels(std::countr_zero(std::bit_ceil(sorted.size + 1))) {
+            size_t next = 0;
+            fill(sorted, 1, next);
+        }
+
+        [[nodiscard]] size_t size() const { return count; }
+
+        // Same result as salad::binary_search / branchless_lower_bound on the sorted input
+        [[nodiscard]] size_t lower_bound(const T val) const {
+            size_t k = 1;
+            for (size_t level = 0; level < levels; level++) {
+                __builtin_prefetch(tree.data + k * prefetch_stride);
+                k = 2 * k + (tree[k] < val);
+            }
+            return rank_of(k);
+        }
+
+        void lower_bound_batch(const ArrayView<T> queries, const ArrayView<size_t> out) const {
+            for (size_t q = 0; q < queries.size; q += search_batch) {
+                const size_t group = queries.size - q < search_batch ? queries.size - q : search_batch;
+                size_t ks[search_batch];
+                for (size_t g = 0; g < group; g++) {
+                    ks[g] = 1;
+                }
+
+                for (size_t level = 0; level < levels; level++) {
+                    for (size_t g = 0; g < group; g++) {
+                        __builtin_prefetch(tree.data + ks[g] * prefetch_stride);
+                        ks[g] = 2 * ks[g] + (tree[ks[g]] < queries[q + g]);
+                    }
+                }
+
+                for (size_t g = 0; g < group; g++) {
+                    out[q + g] = rank_of(ks[g]);
+                }
+            }
+        }
+
+    private:
+        // Grandchildren 4 levels down of node k start at 16k, one cache line of 32-bit keys
+        static constexpr size_t prefetch_stride = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+
+        Array<T> tree;      // 1-indexed, tree[0] is unused
+        size_t count;
+        size_t levels;
+
+        // In-order traversal writes the sorted values (then the padding) into BFS positions
+        void fill(const ArrayView<T> sorted, const size_t k, size_t& next) {
+            if (k >= tree.size) {
+                return;
+            }
+            fill(sorted, 2 * k, next);
+            tree[k] = next < sorted.size ? sorted[next] : std::numeric_limits<T>::max();
+            next++;
+            fill(sorted, 2 * k + 1, next);
+        }
+
+        // k is past the leaves, its path encodes the search: dropping the trailing right turns (and the final left
+        // turn) gives the node of the answer, whose in-order position is its rank in the sorted input
+        [[nodiscard]] size_t rank_of(size_t k) const {
+            k >>= std::countr_one(k) + 1;
+            if (k == 0) {
+                return count;
+            }
+
+            const size_t depth = std::bit_width(k) - 1;
+            const size_t rank = (((k - (size_t{1} << depth)) * 2 + 1) << (levels - 1 - depth)) - 1;
+            return rank < count ? rank : count;
+        }
+    };
+}
+
+#endif //SEARCH_INDEX_H
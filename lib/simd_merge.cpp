@@ -0,0 +1,321 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "simd_merge.h"
+
+#include <cstring>
+#include <type_traits>
+#include <immintrin.h>
+
+namespace salad::simd {
+    namespace {
+        // Every register type provides load/store, lane-wise min/max, a lane reversal, and bitonic_sort which
+        // sorts a bitonic sequence held in one register (log2(lanes) compare-exchange steps)
+
+        template<bool Signed>
+        struct Avx2x32 {
+            using elem = std::conditional_t<Signed, int32_t, uint32_t>;
+            using reg = __m256i;
+            static constexpr size_t lanes = 8;
+
+            [[gnu::target("avx2")]] static reg load(const elem* p) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            }
+            [[gnu::target("avx2")]] static void store(elem* p, const reg x) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+            }
+            [[gnu::target("avx2")]] static reg min(const reg a, const reg b) {
+                return Signed ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+            }
+            [[gnu::target("avx2")]] static reg max(const reg a, const reg b) {
+                return Signed ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+            }
+            [[gnu::target("avx2")]] static reg reverse(const reg x) {
+                return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+            }
+            [[gnu::target("avx2")]] static reg bitonic_sort(reg x) {
+                reg t = _mm256_permute2x128_si256(x, x, 1);
+                x = _mm256_blend_epi32(min(x, t), max(x, t), 0xF0);
+                t = _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+                x = _mm256_blend_epi32(min(x, t), max(x, t), 0xCC);
+                t = _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+                return _mm256_blend_epi32(min(x, t), max(x, t), 0xAA);
+            }
+        };
+
+        template<bool Signed>
+        struct Avx2x64 {
+            using elem = std::conditional_t<Signed, int64_t, uint64_t>;
+            using reg = __m256i;
+            static constexpr size_t lanes = 4;
+
+            [[gnu::target("avx2")]] static reg load(const elem* p) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            }
+            [[gnu::target("avx2")]] static void store(elem* p, const reg x) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+            }
+            // AVX2 has no 64-bit min/max, only a signed compare (unsigned compares with the sign bits flipped)
+            [[gnu::target("avx2")]] static reg greater(const reg a, const reg b) {
+                if constexpr (Signed) {
+                    return _mm256_cmpgt_epi64(a, b);
+                } else {
+                    const reg bias = _mm256_set1_epi64x(INT64_MIN);
+                    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+                }
+            }
+            [[gnu::target("avx2")]] static reg min(const reg a, const reg b) {
+                return _mm256_blendv_epi8(a, b, greater(a, b));
+            }
+            [[gnu::target("avx2")]] static reg max(const reg a, const reg b) {
+                return _mm256_blendv_epi8(b, a, greater(a, b));
+            }
+            [[gnu::target("avx2")]] static reg reverse(const reg x) {
+                return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+            [[gnu::target("avx2")]] static reg bitonic_sort(reg x) {
+                reg t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 3, 2));
+                x = _mm256_blend_epi32(min(x, t), max(x, t), 0xF0);
+                t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 3, 0, 1));
+                return _mm256_blend_epi32(min(x, t), max(x, t), 0xCC);
+            }
+        };
+
+        template<bool Signed>
+        struct Avx512x32 {
+            using elem = std::conditional_t<Signed, int32_t, uint32_t>;
+            using reg = __m512i;
+            static constexpr size_t lanes = 16;
+
+            [[gnu::target("avx512f")]] static reg load(const elem* p) {
+                return _mm512_loadu_si512(p);
+            }
+            [[gnu::target("avx512f")]] static void store(elem* p, const reg x) {
+                _mm512_storeu_si512(p, x);
+            }
+            [[gnu::target("avx512f")]] static reg min(const reg a, const reg b) {
+                return Signed ? _mm512_min_epi32(a, b) : _mm512_min_epu32(a, b);
+            }
+            [[gnu::target("avx512f")]] static reg max(const reg a, const reg b) {
+                return Signed ? _mm512_max_epi32(a, b) : _mm512_max_epu32(a, b);
+            }
+            [[gnu::target("avx512f")]] static reg reverse(const reg x) {
+                return _mm512_permutexvar_epi32(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), x);
+            }
+            // Compare-exchange lane i with lane i ^ distance, the upper lane of each pair keeps the max
+            [[gnu::target("avx512f")]] static reg exchange(const reg x, const reg partner, const __mmask16 upper) {
+                const reg t = _mm512_permutexvar_epi32(partner, x);
+                return _mm512_mask_blend_epi32(upper, min(x, t), max(x, t));
+            }
+            [[gnu::target("avx512f")]] static reg bitonic_sort(reg x) {
+                x = exchange(x, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7), 0xFF00);
+                x = exchange(x, _mm512_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11), 0xF0F0);
+                x = exchange(x, _mm512_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13), 0xCCCC);
+                return exchange(x, _mm512_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14), 0xAAAA);
+            }
+        };
+
+        template<bool Signed>
+        struct Avx512x64 {
+            using elem = std::conditional_t<Signed, int64_t, uint64_t>;
+            using reg = __m512i;
+            static constexpr size_t lanes = 8;
+
+            [[gnu::target("avx512f")]] static reg load(const elem* p) {
+                return _mm512_loadu_si512(p);
+            }
+            [[gnu::target("avx512f")]] static void store(elem* p, const reg x) {
+                _mm512_storeu_si512(p, x);
+            }
+            [[gnu::target("avx512f")]] static reg min(const reg a, const reg b) {
+                return Signed ? _mm512_min_epi64(a, b) : _mm512_min_epu64(a, b);
+            }
+            [[gnu::target("avx512f")]] static reg max(const reg a, const reg b) {
+                return Signed ? _mm512_max_epi64(a, b) : _mm512_max_epu64(a, b);
+            }
+            [[gnu::target("avx512f")]] static reg reverse(const reg x) {
+                return _mm512_permutexvar_epi64(_mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0), x);
+            }
+            [[gnu::target("avx512f")]] static reg exchange(const reg x, const reg partner, const __mmask8 upper) {
+                const reg t = _mm512_permutexvar_epi64(partner, x);
+                return _mm512_mask_blend_epi64(upper, min(x, t), max(x, t));
+            }
+            [[gnu::target("avx512f")]] static reg bitonic_sort(reg x) {
+                x = exchange(x, _mm512_setr_epi64(4, 5, 6, 7, 0, 1, 2, 3), 0xF0);
+                x = exchange(x, _mm512_setr_epi64(2, 3, 0, 1, 6, 7, 4, 5), 0xCC);
+                return exchange(x, _mm512_setr_epi64(1, 0, 3, 2, 5, 4, 7, 6), 0xAA);
+            }
+        };
+
+        template<typename E>
+        void merge_scalar(const E* a, const E* a_end, const E* b, const E* b_end, E* out) {
+            while (a != a_end && b != b_end) {
+                const bool take_b = *b < *a;
+                *out++ = take_b ? *b : *a;
+                a += !take_b;
+                b += take_b;
+            }
+            std::memcpy(out, a, sizeof(E) * (a_end - a));
+            out += a_end - a;
+            std::memcpy(out, b, sizeof(E) * (b_end - b));
+        }
+
+        // Keeps the largest lanes elements seen so far in hi. Every step merges hi with the next block of
+        // whichever input has the smaller head: the low half of the result is final, the high half carries over.
+        // The registers never leave the target-specific member functions, so the generic driver below stays
+        // free of vector types.
+        template<typename Ops>
+        struct Avx2Merger {
+            using elem = typename Ops::elem;
+            static constexpr size_t lanes = Ops::lanes;
+            typename Ops::reg hi;
+
+            [[gnu::target("avx2")]] void step(typename Ops::reg lo, elem* out) {
+                const auto reversed = Ops::reverse(hi);
+                hi = Ops::bitonic_sort(Ops::max(lo, reversed));
+                Ops::store(out, Ops::bitonic_sort(Ops::min(lo, reversed)));
+            }
+            [[gnu::target("avx2")]] void first(const elem* a, const elem* b, elem* out) {
+                hi = Ops::load(b);
+                step(Ops::load(a), out);
+            }
+            [[gnu::target("avx2")]] void next(const elem* block, elem* out) {
+                step(Ops::load(block), out);
+            }
+            [[gnu::target("avx2")]] void drain(elem* carry) const {
+                Ops::store(carry, hi);
+            }
+        };
+
+        template<typename Ops>
+        struct Avx512Merger {
+            using elem = typename Ops::elem;
+            static constexpr size_t lanes = Ops::lanes;
+            typename Ops::reg hi;
+
+            [[gnu::target("avx512f")]] void step(typename Ops::reg lo, elem* out) {
+                const auto reversed = Ops::reverse(hi);
+                hi = Ops::bitonic_sort(Ops::max(lo, reversed));
+                Ops::store(out, Ops::bitonic_sort(Ops::min(lo, reversed)));
+            }
+            [[gnu::target("avx512f")]] void first(const elem* a, const elem* b, elem* out) {
+                hi = Ops::load(b);
+                step(Ops::load(a), out);
+            }
+            [[gnu::target("avx512f")]] void next(const elem* block, elem* out) {
+                step(Ops::load(block), out);
+            }
+            [[gnu::target("avx512f")]] void drain(elem* carry) const {
+                Ops::store(carry, hi);
+            }
+        };
+
+        template<typename Merger>
+        void merge_kernel(const typename Merger::elem* a, const size_t a_size, const typename Merger::elem* b,
+                          const size_t b_size, typename Merger::elem* out) {
+            using elem = typename Merger::elem;
+            constexpr size_t lanes = Merger::lanes;
+
+            const elem* a_end = a + a_size;
+            const elem* b_end = b + b_size;
+
+            Merger merger;
+            merger.first(a, b, out);
+            a += lanes;
+            b += lanes;
+            out += lanes;
+
+            while (static_cast<size_t>(a_end - a) >= lanes && static_cast<size_t>(b_end - b) >= lanes) {
+                if (*a < *b) {
+                    merger.next(a, out);
+                    a += lanes;
+                } else {
+                    merger.next(b, out);
+                    b += lanes;
+                }
+                out += lanes;
+            }
+
+            // What's left: the carried over register and the tails of both inputs
+            elem carry[lanes];
+            merger.drain(carry);
+            const elem* c = carry;
+            const elem* c_end = carry + lanes;
+            while (c != c_end) {
+                if (a != a_end && *a < *c && (b == b_end || *a <= *b)) {
+                    *out++ = *a++;
+                } else if (b != b_end && *b < *c) {
+                    *out++ = *b++;
+                } else {
+                    *out++ = *c++;
+                }
+            }
+            merge_scalar(a, a_end, b, b_end, out);
+        }
+
+        enum class SimdLevel { none, avx2, avx512 };
+
+        SimdLevel detect_simd() {
+            static const SimdLevel level = [] {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) {
+                    return SimdLevel::avx512;
+                }
+                if (__builtin_cpu_supports("avx2")) {
+                    return SimdLevel::avx2;
+                }
+                return SimdLevel::none;
+            }();
+            return level;
+        }
+
+        template<typename Ops>
+        [[gnu::target("avx2"), gnu::flatten]] void merge_avx2(const typename Ops::elem* a, const size_t a_size,
+                                                              const typename Ops::elem* b, const size_t b_size,
+                                                              typename Ops::elem* out) {
+            merge_kernel<Avx2Merger<Ops>>(a, a_size, b, b_size, out);
+        }
+
+        template<typename Ops>
+        [[gnu::target("avx512f"), gnu::flatten]] void merge_avx512(const typename Ops::elem* a, const size_t a_size,
+                                                                   const typename Ops::elem* b, const size_t b_size,
+                                                                   typename Ops::elem* out) {
+            merge_kernel<Avx512Merger<Ops>>(a, a_size, b, b_size, out);
+        }
+
+        // Widest kernel that both runs can fill at least one register of
+        template<typename Wide, typename Narrow, typename E>
+        bool dispatch(const E* a, const size_t a_size, const E* b, const size_t b_size, E* out) {
+            const size_t shortest = a_size < b_size ? a_size : b_size;
+            const SimdLevel level = detect_simd();
+            if (level == SimdLevel::avx512 && shortest >= Wide::lanes) {
+                merge_avx512<Wide>(a, a_size, b, b_size, out);
+                return true;
+            }
+            if (level != SimdLevel::none && shortest >= Narrow::lanes) {
+                merge_avx2<Narrow>(a, a_size, b, b_size, out);
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool merge(const int32_t* a, const size_t a_size, const int32_t* b, const size_t b_size, int32_t* out) {
+        return dispatch<Avx512x32<true>, Avx2x32<true>>(a, a_size, b, b_size, out);
+    }
+
+    bool merge(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out) {
+        return dispatch<Avx512x32<false>, Avx2x32<false>>(a, a_size, b, b_size, out);
+    }
+
+    bool merge(const int64_t* a, const size_t a_size, const int64_t* b, const size_t b_size, int64_t* out) {
+        return dispatch<Avx512x64<true>, Avx2x64<true>>(a, a_size, b, b_size, out);
+    }
+
+    bool merge(const uint64_t* a, const size_t a_size, const uint64_t* b, const size_t b_size, uint64_t* out) {
+        return dispatch<Avx512x64<false>, Avx2x64<false>>(a, a_size, b, b_size, out);
+    }
+}
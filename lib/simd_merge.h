@@ -0,0 +1,25 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef SIMD_MERGE_H
+#define SIMD_MERGE_H
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+
+namespace salad::simd {
+    // Smallest run the vector kernels take, shorter merges aren't worth a call
+    inline constexpr size_t merge_min_run = 8;
+
+    // Merges the sorted runs a and b into out (which must not overlap them) with a bitonic merge network over
+    // AVX-512 or AVX2 registers, whichever the CPU supports. Returns false without touching out if neither is
+    // available or the runs are too short for the widest usable kernel.
+    bool merge(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    bool merge(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+    bool merge(const int64_t* a, size_t a_size, const int64_t* b, size_t b_size, int64_t* out);
+    bool merge(const uint64_t* a, size_t a_size, const uint64_t* b, size_t b_size, uint64_t* out);
+}
+
+#endif //SIMD_MERGE_H
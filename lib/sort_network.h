@@ -0,0 +1,171 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef SORT_NETWORK_H
+#define SORT_NETWORK_H
+#include <array>
+#include <cstddef> // size_t and some other types
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace salad::network {
+    // Block sizes there's a network for
+    template<size_t N>
+    inline constexpr bool has_network = N == 8 || N == 16 || N == 32 || N == 64;
+
+    template<typename T, size_t N>
+    inline constexpr bool supported = has_network<N> && std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+    struct Comparator {
+        uint8_t lo;
+        uint8_t hi;
+    };
+
+    // Batcher's odd-even merge sort, calls emit(lo, hi) for every compare-exchange in order
+    template<size_t N, typename F>
+    constexpr void batcher(F emit) {
+        for (size_t p = 1; p < N; p *= 2) {
+            for (size_t k = p; k >= 1; k /= 2) {
+                for (size_t j = k % p; j + k < N; j += 2 * k) {
+                    for (size_t i = 0; i < k && i + j + k < N; i++) {
+                        if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                            emit(i + j, i + j + k);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    template<size_t N>
+    consteval size_t comparator_count() {
+        size_t count = 0;
+        batcher<N>([&](size_t, size_t) { count++; });
+        return count;
+    }
+
+    template<size_t N>
+    consteval std::array<Comparator, comparator_count<N>()> comparators() {
+        std::array<Comparator, comparator_count<N>()> pairs{};
+        size_t next = 0;
+        batcher<N>([&](const size_t lo, const size_t hi) {
+            pairs[next++] = Comparator{static_cast<uint8_t>(lo), static_cast<uint8_t>(hi)};
+        });
+        return pairs;
+    }
+
+    // Works on scalars and on GCC vector types alike (where it's a lane-wise min and max)
+    template<typename V>
+    [[gnu::always_inline]] inline void compare_exchange(V& a, V& b) {
+        const V lo = a < b ? a : b;
+        const V hi = a < b ? b : a;
+        a = lo;
+        b = hi;
+    }
+
+    // The network is unrolled at compile time, every index is a constant so the values stay in registers
+    template<size_t N, typename V>
+    [[gnu::always_inline]] inline void sort(V* v) {
+        static constexpr auto pairs = comparators<N>();
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (compare_exchange(v[pairs[I].lo], v[pairs[I].hi]), ...);
+        }(std::make_index_sequence<pairs.size()>{});
+    }
+
+    // Sorts Bytes / sizeof(T) blocks of N at once: block l goes into lane l, so element i of every block sits
+    // in vector i and each comparator is a single min and max over all of them
+    template<typename T, size_t N, size_t Bytes>
+    [[gnu::always_inline]] inline void sort_lanes(T* data) {
+        constexpr size_t lanes = Bytes / sizeof(T);
+        typedef T vec __attribute__((vector_size(Bytes)));
+
+        alignas(Bytes) T columns[N * lanes];
+        for (size_t l = 0; l < lanes; l++) {
+            for (size_t i = 0; i < N; i++) {
+                columns[i * lanes + l] = data[l * N + i];
+            }
+        }
+
+        vec v[N];
+        std::memcpy(v, columns, sizeof(v));
+        sort<N>(v);
+        std::memcpy(columns, v, sizeof(v));
+
+        for (size_t l = 0; l < lanes; l++) {
+            for (size_t i = 0; i < N; i++) {
+                data[l * N + i] = columns[i * lanes + l];
+            }
+        }
+    }
+
+    template<typename T, size_t N, size_t Bytes>
+    [[gnu::always_inline]] inline void sort_blocks_with(T* data, const size_t blocks) {
+        constexpr size_t lanes = Bytes / sizeof(T);
+        size_t b = 0;
+        for (; b + lanes <= blocks; b += lanes) {
+            sort_lanes<T, N, Bytes>(data + b * N);
+        }
+        // Fewer blocks left than lanes, these go one at a time
+        for (; b < blocks; b++) {
+            T v[N];
+            std::memcpy(v, data + b * N, sizeof(v));
+            sort<N>(v);
+            std::memcpy(data + b * N, v, sizeof(v));
+        }
+    }
+
+    template<typename T, size_t N>
+    [[gnu::target("avx512f,avx512bw"), gnu::flatten]] void sort_blocks_avx512(T* data, const size_t blocks) {
+        sort_blocks_with<T, N, 64>(data, blocks);
+    }
+
+    template<typename T, size_t N>
+    [[gnu::target("avx2"), gnu::flatten]] void sort_blocks_avx2(T* data, const size_t blocks) {
+        sort_blocks_with<T, N, 32>(data, blocks);
+    }
+
+    template<typename T, size_t N>
+    [[gnu::flatten]] void sort_blocks_sse(T* data, const size_t blocks) {
+        sort_blocks_with<T, N, 16>(data, blocks);
+    }
+
+    enum class SimdLevel { sse, avx2, avx512 };
+
+    inline SimdLevel detect_simd() {
+        static const SimdLevel level = [] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+                return SimdLevel::avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::avx2;
+            }
+            return SimdLevel::sse;
+        }();
+        return level;
+    }
+
+    // Sorts blocks consecutive blocks of N elements each, with the widest vectors the CPU has
+    template<typename T, size_t N>
+    void sort_blocks(T* data, const size_t blocks) {
+        static_assert(supported<T, N>, "There are only networks for 8, 16, 32 and 64 arithmetic elements");
+        switch (detect_simd()) {
+            case SimdLevel::avx512:
+                sort_blocks_avx512<T, N>(data, blocks);
+                break;
+            case SimdLevel::avx2:
+                sort_blocks_avx2<T, N>(data, blocks);
+                break;
+            default:
+                sort_blocks_sse<T, N>(data, blocks);
+                break;
+        }
+    }
+}
+
+#endif //SORT_NETWORK_H
@@ -0,0 +1,153 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef SORTED_BLOCKS_H
+#define SORTED_BLOCKS_H
+#include <algorithm>
+#include <cstddef> // size_t and some other types
+#include <cstring>
+#include <vector>
+#include "arr_util.h"
+
+namespace salad {
+    // Sorted multiset kept as a list of sorted blocks of at most Block values each, with the rank of every
+    // block's first value alongside. Finding a value or a rank is a binary search over the blocks and then
+    // inside one, an insertion shifts at most one block and bumps the ranks of the blocks after it. That
+    // last part is linear in size / Block, but it's a tight loop over a small array that stays far below
+    // the cost of the searches for any size that fits in memory
+    template<typename T, size_t Block = 1024>
+    class SortedBlocks {
+    public:
+        // Blocks built from sorted input are filled this far, so the first insertions don't all split
+        static constexpr size_t initial_fill = Block * 3 / 4;
+
+        SortedBlocks() = default;
+
+        // sorted must be ascending
+        explicit SortedBlocks(const ArrayView<T> sorted) {
+            for (size_t first = 0; first < sorted.size; first += initial_fill) {
+                const size_t count = std::min(initial_fill, sorted.size - first);
+                Array<T> block = Array<T>(Block, uninitialized);
+                std::memcpy(block.data, sorted.data + first, count * sizeof(T));
+                block.size = count;
+                blocks.push_back(std::move(block));
+                starts.push_back(first);
+            }
+            total = sorted.size;
+        }
+
+        [[nodiscard]] size_t size() const { return total; }
+
+        // Number of values <= value, which is where insert(value) puts it
+        [[nodiscard]] size_t upper_rank(const T value) const {
+            if (blocks.empty()) {
+                return 0;
+            }
+            const size_t b = block_for(value);
+            const Array<T>& block = blocks[b];
+            return starts[b] + (std::upper_bound(block.data, block.data + block.size, value) - block.data);
+        }
+
+        // Inserts value after every equal one and returns its rank
+        size_t insert(const T value) {
+            if (blocks.empty()) {
+                blocks.push_back(Array<T>(Block, uninitialized));
+                blocks.back().size = 0;
+                starts.push_back(0);
+            }
+
+            size_t b = block_for(value);
+            if (blocks[b].size == Block) {
+                split(b);
+                b += value >= blocks[b + 1][0];
+            }
+
+            Array<T>& block = blocks[b];
+            T* at = std::upper_bound(block.data, block.data + block.size, value);
+            std::memmove(at + 1, at, (block.data + block.size - at) * sizeof(T));
+            *at = value;
+            block.size++;
+
+            for (size_t later = b + 1; later < starts.size(); later++) {
+                starts[later]++;
+            }
+            total++;
+            return starts[b] + (at - block.data);
+        }
+
+        // Walks the values in order from a rank on
+        class Cursor {
+        public:
+            T operator*() const { return (*blocks)[block][offset]; }
+            Cursor& operator++() {
+                if (++offset == (*blocks)[block].size) {
+                    block++;
+                    offset = 0;
+                }
+                return *this;
+            }
+
+        private:
+            friend class SortedBlocks;
+            Cursor(const std::vector<Array<T>>* blocks, const size_t block, const size_t offset)
+                : blocks(blocks), block(block), offset(offset) {}
+
+            const std::vector<Array<T>>* blocks;
+            size_t block;
+            size_t offset;
+        };
+
+        // rank must be below size()
+        [[nodiscard]] Cursor at(const size_t rank) const {
+            const size_t b = std::upper_bound(starts.begin(), starts.end(), rank) - starts.begin() - 1;
+            return Cursor(&blocks, b, rank - starts[b]);
+        }
+
+        [[nodiscard]] T operator[](const size_t rank) const { return *at(rank); }
+
+        // Copies every value, in order, to out (which holds at least size() of them)
+        void copy_to(T* out) const {
+            for (const Array<T>& block : blocks) {
+                std::memcpy(out, block.data, block.size * sizeof(T));
+                out += block.size;
+            }
+        }
+
+    private:
+        // Block that value belongs in: the first whose last value is above it, or the last block
+        [[nodiscard]] size_t block_for(const T value) const {
+            size_t lo = 0;
+            size_t hi = blocks.size() - 1;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                const Array<T>& block = blocks[mid];
+                if (block.size != 0 && value < block[block.size - 1]) {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+            return lo;
+        }
+
+        // Moves the upper half of a full block into a new one right after it
+        void split(const size_t b) {
+            constexpr size_t half = Block / 2;
+            Array<T> upper = Array<T>(Block, uninitialized);
+            std::memcpy(upper.data, blocks[b].data + half, (Block - half) * sizeof(T));
+            upper.size = Block - half;
+            blocks[b].size = half;
+            blocks.insert(blocks.begin() + b + 1, std::move(upper));
+            starts.insert(starts.begin() + b + 1, starts[b] + half);
+        }
+
+        std::vector<Array<T>> blocks;   // size is the number of values in use, every block has room for Block
+        std::vector<size_t> starts;     // Rank of the first value of every block
+        size_t total = 0;
+    };
+}
+
+#endif //SORTED_BLOCKS_H
@@ -0,0 +1,131 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#include "thread_pool.h"
+
+namespace salad {
+    namespace {
+        // Which pool (if any) the calling thread works for, and its queue in that pool
+        thread_local const ThreadPool* worker_pool = nullptr;
+        thread_local size_t worker_index = 0;
+    }
+
+    ThreadPool::ThreadPool(size_t threads) {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+            threads = threads > 0 ? threads : 1;
+        }
+
+        for (size_t i = 0; i <= threads; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back(&ThreadPool::worker_loop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool& ThreadPool::global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t ThreadPool::own_queue() const {
+        return worker_pool == this ? worker_index : workers.size();
+    }
+
+    void ThreadPool::run(TaskGroup& group, Task task) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Queue& queue = *queues[own_queue()];
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.emplace_back([&group, task = std::move(task)] {
+                task();
+                group.pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        {
+            // Taking the lock orders this with a worker that is about to go to sleep
+            std::lock_guard lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+
+    void ThreadPool::wait(TaskGroup& group) {
+        const size_t self = own_queue();
+        Task task;
+        while (group.pending.load(std::memory_order_acquire) > 0) {
+            if (try_pop(self, task)) {
+                task();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool ThreadPool::try_pop(const size_t self, Task& task) {
+        if (queued.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        // Newest task of our own queue first
+        {
+            Queue& queue = *queues[self];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // Otherwise steal the oldest task (usually the largest piece of work) from someone else
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& queue = *queues[(self + i) % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::worker_loop(const size_t index) {
+        worker_pool = this;
+        worker_index = index;
+
+        Task task;
+        while (true) {
+            if (try_pop(index, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+            if (stopping && queued.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+}
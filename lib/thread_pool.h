@@ -0,0 +1,81 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef> // size_t and some other types
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace salad {
+    // Small work-stealing pool for fork/join style work.
+    // Every worker owns a deque: it pushes and pops at the back (LIFO, cache friendly), idle workers steal from
+    // the front of the others. Threads waiting on a TaskGroup run queued tasks instead of blocking, so tasks
+    // may themselves fork and wait without deadlocking the pool.
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        // Tracks the outstanding tasks of one fork/join region
+        struct TaskGroup {
+            std::atomic<size_t> pending{0};
+        };
+
+        // 0 threads means one per hardware thread
+        explicit ThreadPool(size_t threads = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        // Shared pool sized to the machine, created on first use
+        static ThreadPool& global();
+
+        [[nodiscard]] size_t size() const { return workers.size(); }
+
+        void run(TaskGroup& group, Task task);
+        // Returns once every task of the group has finished, running queued tasks in the meantime
+        void wait(TaskGroup& group);
+
+        // Calls body(range_begin, range_end) on [begin, end) split into grain sized ranges
+        template<typename F>
+        void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+            grain = grain > 0 ? grain : 1;
+            TaskGroup group;
+            for (size_t i = begin; i < end; i += grain) {
+                const size_t stop = end - i > grain ? i + grain : end;
+                run(group, [&body, i, stop] { body(i, stop); });
+            }
+            wait(group);
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // One queue per worker, plus a last one shared by threads outside the pool
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        std::atomic<size_t> queued{0};
+        std::atomic<bool> stopping{false};
+
+        [[nodiscard]] size_t own_queue() const;
+        bool try_pop(size_t self, Task& task);
+        void worker_loop(size_t index);
+    };
+}
+
+#endif //THREAD_POOL_H
@@ -0,0 +1,182 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "main.h"
+#include "cpu_info.h"
+#include "thread_pool.h"
+
+namespace salad::autotune {
+    // Pairs of neighbours looked at, spread evenly over the input
+    inline constexpr size_t sample_size = 256;
+
+    // At most one in this many elements is sampled, so small inputs don't pay more for the profile than the sort
+    inline constexpr size_t sample_density = 16;
+
+    // Inputs up to this size aren't worth sampling
+    inline constexpr size_t tiny = 64;
+
+    struct Profile {
+        size_t size = 0;
+        size_t sampled = 0;
+        size_t ascending = 0;   // Sampled neighbours already in order
+        size_t turns = 0;       // Changes of direction from one sampled value to the next, about twice the long runs
+        size_t distinct = 0;    // Distinct values among the sampled ones
+        uint64_t range = 0;     // max - min of the sampled values
+    };
+
+    template<typename T>
+    Profile profile (const ArrayView<T> arr) {
+        static_assert(std::is_integral_v<T>, "The autotuner only picks between integer sorts");
+        using key_t = std::make_unsigned_t<T>;
+
+        Profile p;
+        p.size = arr.size;
+        if (arr.size < 2) {
+            return p;
+        }
+
+        const size_t wanted = std::clamp<size_t>(arr.size / sample_density, 1, sample_size);
+        const size_t stride = std::max<size_t>((arr.size - 1) / wanted, 1);
+
+        // Distinct values are counted in an open addressing table at most half full
+        constexpr size_t slots = sample_size * 2;
+        key_t seen[slots];
+        bool used[slots] = {};
+
+        T min = arr[0];
+        T max = arr[0];
+        T previous = arr[0];
+        bool rising = true;
+        for (size_t i = 0; i + 1 < arr.size && p.sampled < wanted; i += stride) {
+            const T value = arr[i];
+            p.ascending += value <= arr[i + 1];
+            if (p.sampled > 0) {
+                p.turns += p.sampled > 1 && rising != (previous <= value);
+                rising = previous <= value;
+            }
+            previous = value;
+            p.sampled++;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+
+            const key_t key = static_cast<key_t>(value);
+            size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) % slots;
+            while (used[slot] && seen[slot] != key) {
+                slot = (slot + 1) % slots;
+            }
+            p.distinct += !used[slot];
+            used[slot] = true;
+            seen[slot] = key;
+        }
+
+        p.range = static_cast<key_t>(max) - static_cast<key_t>(min);
+        return p;
+    }
+
+    template<typename T>
+    struct Engine {
+        std::string_view name;
+        Array<T>& (*sort)(Array<T>&);
+    };
+
+    // Every instantiation the autotuner can dispatch to
+    template<typename T>
+    std::span<const Engine<T>> engines () {
+        static const Engine<T> table[] = {
+            {"insertion_sort", insertion_sort<T>},
+            {"merge_sort", merge_sort<T>},
+            {"imerge_sort<16>", merge_sort_iterative<T, 16>},
+            {"imerge_sort<32>", merge_sort_iterative<T, 32>},
+            {"imerge_sort<64>", merge_sort_iterative<T, 64>},
+            {"pmerge_sort<32>", parallel_merge_sort_iterative<T, 32>},
+            {"pmerge_sort<64>", parallel_merge_sort_iterative<T, 64>},
+            {"nmerge_sort", natural_merge_sort<T>},
+            {"radix_sort", radix_sort<T>},
+        };
+        return table;
+    }
+
+    template<typename T>
+    const Engine<T>& engine (const std::string_view name) {
+        for (const Engine<T>& e : engines<T>()) {
+            if (e.name == name) {
+                return e;
+            }
+        }
+        return engines<T>().front();
+    }
+
+    // Rules measured with AoC_bench (ns per element), cache sizes turn them into element counts for T
+    template<typename T>
+    const Engine<T>& choose (const Profile& p, const CacheInfo& caches, const size_t threads) {
+        const size_t bytes = p.size * sizeof(T);
+
+        // Short arrays never reach the merges anyway
+        if (p.size <= tiny) {
+            return engine<T>("insertion_sort");
+        }
+
+        // A base case group (K elements in each lane of a 64 byte vector) should leave most of L1 to the merges,
+        // and there should be enough chunks that the merges aren't dominated by an insertion sorted tail
+        constexpr size_t widest_group = 64 * 64;
+        const bool small_l1 = widest_group > caches.l1d / 4;
+        const size_t k = !small_l1 && p.size >= 64 * 16 ? 64 : p.size >= 32 * 16 ? 32 : 16;
+        const bool use_pmerge = threads > 1 && bytes > caches.l2;
+
+        auto merge_engine = [&]() -> const Engine<T>& {
+            if (use_pmerge) {
+                return engine<T>(k == 64 ? "pmerge_sort<64>" : "pmerge_sort<32>");
+            }
+            return engine<T>(k == 64 ? "imerge_sort<64>" : k == 32 ? "imerge_sort<32>" : "imerge_sort<16>");
+        };
+
+        // Mostly sorted either way round, or made of a few long runs (like a sorted column with a tail
+        // appended): the natural merge sort only has to reverse and merge those, radix would still scatter
+        // every element
+        if (p.ascending >= p.sampled - p.sampled / 8 || p.ascending <= p.sampled / 8 || p.turns <= p.sampled / 16) {
+            return engine<T>("nmerge_sort");
+        }
+
+        // Radix sort builds its histograms in one pass whatever the range, then skips the digits the range
+        // doesn't use. With up to four digits it overtakes the merge sorts once the input outgrows half of L1,
+        // wider keys need more elements to amortize their extra passes
+        const size_t digits = std::max<size_t>((std::bit_width(p.range) + 7) / 8, 1);
+        const size_t radix_bytes = caches.l1d / 2 * std::max<size_t>(digits / 4, 1);
+        // Few distinct values keep the scatter writes on a handful of cache lines
+        const bool few_distinct = p.distinct <= p.sampled / 8;
+
+        if (bytes >= radix_bytes && (!use_pmerge || few_distinct)) {
+            return engine<T>("radix_sort");
+        }
+        return merge_engine();
+    }
+
+    template<typename T>
+    const Engine<T>& choose (const ArrayView<T> arr) {
+        if (arr.size <= tiny) {
+            return engine<T>("insertion_sort");
+        }
+        return choose<T>(profile(arr), cache_info(), ThreadPool::global().size());
+    }
+
+    // Samples arr and sorts it with whichever engine fits best
+    template<typename T>
+    Array<T>& sort (Array<T>& arr) {
+        return choose<T>(arr.view()).sort(arr);
+    }
+}
+
+#endif //AUTOTUNE_H
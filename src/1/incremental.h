@@ -0,0 +1,109 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#include "join.h"
+#include "reduce.h"
+#include "sorted_blocks.h"
+
+namespace salad {
+    // Both answers for a growing list of note pairs, updated pair by pair instead of recomputed.
+    //
+    // The similarity only needs how often every value occurs on each side: adding x to note1 adds
+    // x * (occurrences of x in note2), and the same the other way round.
+    //
+    // The difference sum pairs values by rank. Inserting x at rank p into note1 and y at rank q into note2
+    // leaves every pair below min(p, q) alone and moves every pair above max(p, q) up by one rank unchanged,
+    // so only the ranks in between are summed again. That's cheap while new pairs land close to each other
+    // in both columns, but it's linear in |p - q| and not logarithmic in general
+    class IncrementalNotes {
+    public:
+        IncrementalNotes() = default;
+
+        // Starts from two sorted columns of the same length
+        IncrementalNotes(const ArrayView<uint32_t> sorted1, const ArrayView<uint32_t> sorted2)
+            : note1(sorted1), note2(sorted2), distance_sum(abs_diff_sum(sorted1, sorted2)),
+              similarity_sum(similarity_join(sorted1, sorted2)) {
+            for (const uint32_t x : sorted1) {
+                counts1[x]++;
+            }
+            for (const uint32_t y : sorted2) {
+                counts2[y]++;
+            }
+        }
+
+        // Ranks add(x, y) would have to sum again, the part of its cost that isn't logarithmic
+        [[nodiscard]] size_t span(const uint32_t x, const uint32_t y) const {
+            const size_t p = note1.upper_rank(x);
+            const size_t q = note2.upper_rank(y);
+            return (p > q ? p - q : q - p) + 1;
+        }
+
+        void add(const uint32_t x, const uint32_t y) {
+            const size_t p = note1.upper_rank(x);
+            const size_t q = note2.upper_rank(y);
+            const size_t lo = std::min(p, q);
+            const size_t hi = std::max(p, q);
+
+            distance_sum -= pair_sum(lo, hi);
+            note1.insert(x);
+            note2.insert(y);
+            distance_sum += pair_sum(lo, hi + 1);
+
+            similarity_sum += static_cast<uint64_t>(x) * lookup(counts2, x);
+            counts1[x]++;
+            similarity_sum += static_cast<uint64_t>(y) * lookup(counts1, y);
+            counts2[y]++;
+        }
+
+        [[nodiscard]] size_t size() const { return note1.size(); }
+        [[nodiscard]] uint64_t distance() const { return distance_sum; }
+        [[nodiscard]] uint64_t similarity() const { return similarity_sum; }
+
+        // Both columns, sorted, into arrays of at least size() elements
+        void copy_to(uint32_t* sorted1, uint32_t* sorted2) const {
+            note1.copy_to(sorted1);
+            note2.copy_to(sorted2);
+        }
+
+    private:
+        // Sum of |note1[i] - note2[i]| for the ranks [first, last)
+        [[nodiscard]] uint64_t pair_sum(const size_t first, const size_t last) const {
+            if (first >= last) {
+                return 0;
+            }
+            uint64_t sum = 0;
+            auto a = note1.at(first);
+            auto b = note2.at(first);
+            for (size_t i = first; i < last; i++, ++a, ++b) {
+                const uint32_t l = *a;
+                const uint32_t r = *b;
+                sum += l > r ? l - r : r - l;
+            }
+            return sum;
+        }
+
+        static uint64_t lookup(const std::unordered_map<uint32_t, uint64_t>& counts, const uint32_t value) {
+            const auto it = counts.find(value);
+            return it != counts.end() ? it->second : 0;
+        }
+
+        SortedBlocks<uint32_t> note1;
+        SortedBlocks<uint32_t> note2;
+        std::unordered_map<uint32_t, uint64_t> counts1;
+        std::unordered_map<uint32_t, uint64_t> counts2;
+        uint64_t distance_sum = 0;
+        uint64_t similarity_sum = 0;
+    };
+}
+
+#endif //INCREMENTAL_H
@@ -1,166 +1,972 @@
 #include "main.h"
+#include "autotune.h"
+#include "incremental.h"
 
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <fmt/format.h>
 
 #include "color_tools.h"
 #include "arr_util.h"
+#include "block_reader.h"
+#include "external_sort.h"
+#include "input_source.h"
+#include "join.h"
+#include "instrument.h"
+#include "memory.h"
+#include "note_cache.h"
+#include "note_parser.h"
+#include "output_sink.h"
+#include "reduce.h"
 
 using salad::Array;
+using salad::Verbosity;
+
+// Columns at least this large are allocated on huge pages
+constexpr size_t huge_page_threshold = 64 << 20;
+
+// With --mem, one in this many bytes of the budget holds the text being parsed. Each column chunk gets four
+// times that, so it has room for a value per byte of the window (every line is at least one byte), and the
+// sort engine's scratch gets as much as one chunk. 1 + 4 + 4 + 4 shares make up the whole budget
+constexpr size_t external_text_share = 13;
+
+// Smallest --mem accepted: below it the windows get shorter than plausible lines and the merge buffers too
+// small to read the runs in sensible blocks
+constexpr size_t external_min_budget = 64 << 10;
+
+// "64M", "2G", "4096", ... Returns 0 for anything that isn't a size
+size_t parse_size(const std::string_view text) {
+    size_t value = 0;
+    size_t i = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++) {
+        value = value * 10 + (text[i] - '0');
+    }
+    if (i == 0 || i + 1 < text.size()) {
+        return 0;
+    }
+    if (i + 1 == text.size()) {
+        switch (text[i]) {
+            case 'K': case 'k': return value << 10;
+            case 'M': case 'm': return value << 20;
+            case 'G': case 'g': return value << 30;
+            default: return 0;
+        }
+    }
+    return value;
+}
+
+// Out-of-core path for inputs larger than RAM: the notes are read in windows of whole lines, every column is
+// collected in chunks of at most its share of budget and spilled to sorted runs in tmp_dir, and both sums
+// are computed in one pass over the two merged columns, without ever holding a whole column
+int run_external(const char* path, const size_t budget, const std::string& tmp_dir,
+                 Array<uint32_t>& (*sorting_algo)(Array<uint32_t>&)) {
+    const bool from_stdin = std::string_view(path) == "-";
+    const int fd = from_stdin ? STDIN_FILENO : ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open file" << std::endl;
+        return 1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    const size_t window = budget / external_text_share;
+    const size_t column_budget = window * sizeof(uint32_t);
+    salad::ExternalSorter sorted1(column_budget, sorting_algo, tmp_dir);
+    salad::ExternalSorter sorted2(column_budget, sorting_algo, tmp_dir);
+    salad::OutputSink& out = salad::OutputSink::out();
+    out.print(Verbosity::summary, "External sort with a {} byte budget: {} byte text windows, {} values per run\n\n",
+              budget, window, sorted1.capacity());
+
+    // Whatever follows the last newline of a window is carried over to the start of the next one
+    Array<char> text = Array<char>(window, salad::uninitialized);
+    size_t filled = 0;
+    size_t read_total = 0;
+    bool eof = false;
+    while (!eof || filled > 0) {
+        while (!eof && filled < window) {
+            const ssize_t got = ::read(fd, text.data + filled, window - filled);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                eof = true;
+                break;
+            }
+            filled += got;
+            read_total += got;
+        }
+
+        size_t usable = filled;
+        if (!eof) {
+            const void* last = memrchr(text.data, '\n', filled);
+            if (last == nullptr) {
+                std::cerr << fmt::format("A line is longer than the {} byte text window, raise --mem\n", window);
+                return 1;
+            }
+            usable = static_cast<const char*>(last) - text.data + 1;
+        }
+
+        // A window has at most one line per byte, which is what a chunk holds, so every line gets a slot
+        const std::string_view lines(text.data, usable);
+        const size_t line_count = salad::count_lines(lines);
+        const salad::ArrayView<uint32_t> view1 = sorted1.reserve(line_count);
+        const salad::ArrayView<uint32_t> view2 = sorted2.reserve(line_count);
+        Array<uint32_t> column1 = Array<uint32_t>(view1.data, view1.size, false);
+        Array<uint32_t> column2 = Array<uint32_t>(view2.data, view2.size, false);
+        const size_t pairs = salad::parse_notes(lines, column1, column2);
+        sorted1.commit(pairs);
+        sorted2.commit(pairs);
+
+        std::memmove(text.data, text.data + usable, filled - usable);
+        filled -= usable;
+    }
+    if (!from_stdin) {
+        ::close(fd);
+    }
+    text = Array<char>(nullptr, 0, false);
+    out.print(Verbosity::summary, "Read {} characters from file\n\n", read_total);
+
+    sorted1.finish();
+    sorted2.finish();
+    if (sorted1.runs() > 0 || sorted2.runs() > 0) {
+        out.print(Verbosity::summary, "Spilled {} sorted runs to {} and {} to {}\n\n", sorted1.runs(),
+                  sorted1.directory(), sorted2.runs(), sorted2.directory());
+    }
+
+    // The chunks are gone once they're spilled, so the readers of both merges share what they used to take
+    const size_t stream_buffer = column_budget;
+    salad::ExternalSorter::Stream stream1 = sorted1.stream(stream_buffer);
+    salad::ExternalSorter::Stream stream2 = sorted2.stream(stream_buffer);
+
+    // One pass over both merged columns in value order feeds both answers. The similarity needs how often every
+    // value occurs on each side. The difference sum pairs the columns by rank, which adds up to the same as
+    // |values of note1 up to x - values of note2 up to x| over every x in between two values: each pair (a, b)
+    // is counted once for every x in [min(a, b), max(a, b)) it keeps apart
+    uint64_t diffs = 0;
+    uint64_t similarity = 0;
+    int64_t balance = 0;
+    uint32_t previous = 0;
+    uint32_t l = 0;
+    uint32_t r = 0;
+    bool has_l = stream1.next(l);
+    bool has_r = stream2.next(r);
+    while (has_l || has_r) {
+        const uint32_t value = !has_r || (has_l && l < r) ? l : r;
+        diffs += static_cast<uint64_t>(balance < 0 ? -balance : balance) * (value - previous);
+        size_t n1 = 0;
+        while (has_l && l == value) {
+            n1++;
+            has_l = stream1.next(l);
+        }
+        size_t n2 = 0;
+        while (has_r && r == value) {
+            n2++;
+            has_r = stream2.next(r);
+        }
+        balance += static_cast<int64_t>(n1) - static_cast<int64_t>(n2);
+        previous = value;
+
+        if (n1 > 0 && n2 > 0) {
+            similarity += static_cast<uint64_t>(value) * n1 * n2;
+            for (size_t k = 0; k < n1 && out.enabled(Verbosity::verbose); k++) {
+                out.print(Verbosity::verbose, "{:d} appears {:d} times in note2\n", value, n2);
+            }
+        }
+    }
+    out.print(Verbosity::verbose, "\n");
+
+    const int error = sorted1.error() != 0 ? sorted1.error() : sorted2.error();
+    if (error != 0 || stream1.failed() || stream2.failed()) {
+        std::cerr << fmt::format("External sort failed: {}\n", std::strerror(error != 0 ? error : EIO));
+        return 1;
+    }
+
+    out.print(Verbosity::quiet, "Sum of differences of location identifiers: {:d}\n", diffs);
+    out.print(Verbosity::quiet, "Similarity score: {:d}\n\n", similarity);
+    return 0;
+}
+
+// Merges the sorted runs of column, which start at bounds (column.size being the last bound), into one sorted
+// column. Every pass merges neighbouring pairs of runs in parallel and halves their number. Once there are
+// fewer pairs than threads, each merge is split up at co-ranked points (merge path), so the last passes
+// (the final one merges the whole column) run on all threads as well
+void merge_sorted_runs(Array<uint32_t>& column, std::vector<size_t> bounds, salad::ThreadPool& pool) {
+    if (bounds.size() <= 2) {
+        return;
+    }
+    const size_t threads = pool.size() > 0 ? pool.size() : 1;
+    Array<uint32_t> scratch = Array<uint32_t>(column.size, salad::uninitialized);
+    Array<uint32_t>* from = &column;
+    Array<uint32_t>* into = &scratch;
+    while (bounds.size() > 2) {
+        const size_t runs = bounds.size() - 1;
+        const size_t pairs = (runs + 1) / 2;
+        const size_t parts = pairs >= threads ? 1 : (threads * 2 + pairs - 1) / pairs;
+        pool.parallel_for(0, pairs * parts, 1, [&](const size_t first, const size_t last) {
+            for (size_t task = first; task < last; task++) {
+                const size_t pair = task / parts;
+                const size_t part = task % parts;
+                const size_t start = bounds[2 * pair];
+                const size_t mid = bounds[2 * pair + 1];
+                const size_t end = bounds[std::min(2 * pair + 2, runs)];
+                // An odd run out is only copied over
+                const salad::ArrayView<uint32_t> left = (*from)[{start, mid}];
+                const salad::ArrayView<uint32_t> right = (*from)[{mid, end}];
+
+                const size_t out_first = (end - start) * part / parts;
+                const size_t out_last = (end - start) * (part + 1) / parts;
+                const size_t left_first = salad::co_rank(left, right, out_first);
+                const size_t left_last = salad::co_rank(left, right, out_last);
+                salad::merge<uint32_t>(left[{left_first, left_last}],
+                                       right[{out_first - left_first, out_last - left_last}],
+                                       (*into)[{start + out_first, start + out_last}]);
+            }
+        });
+
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < runs; i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        merged.push_back(bounds[runs]);
+        bounds = std::move(merged);
+        std::swap(from, into);
+    }
+    if (from != &column) {
+        column = std::move(scratch);
+    }
+}
+
+// Pipelined path: blocks of the notes are read ahead (through io_uring where the kernel supports it), every
+// block's complete lines are parsed into a run as soon as it lands and the run is sorted on the pool while
+// the next blocks are read. Lines that straddle two blocks are parsed at the end, once everything is read,
+// and only the merge of the sorted runs is left after that
+bool read_pipelined(const char* path, Array<uint32_t>& (*sorting_algo)(Array<uint32_t>&), salad::ThreadPool& pool,
+                    Array<uint32_t>& note1, Array<uint32_t>& note2) {
+    const bool from_stdin = std::string_view(path) == "-";
+    const int fd = from_stdin ? STDIN_FILENO : ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open file" << std::endl;
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // The sorts hold on to the runs, which a deque never moves
+    std::deque<std::pair<Array<uint32_t>, Array<uint32_t>>> runs;
+    salad::ThreadPool::TaskGroup sorting;
+    auto add_run = [&](const std::string_view lines) {
+        const size_t line_count = salad::count_lines(lines);
+        Array<uint32_t> run1 = Array<uint32_t>(line_count, salad::uninitialized);
+        Array<uint32_t> run2 = Array<uint32_t>(line_count, salad::uninitialized);
+        const size_t pairs = salad::parse_notes(lines, run1, run2);
+        if (pairs == 0) {
+            return;
+        }
+        run1.size = pairs;
+        run2.size = pairs;
+        auto& [sorted1, sorted2] = runs.emplace_back(std::move(run1), std::move(run2));
+        pool.run(sorting, [&sorted1, sorting_algo] { sorting_algo(sorted1); });
+        pool.run(sorting, [&sorted2, sorting_algo] { sorting_algo(sorted2); });
+    };
+
+    size_t read_total = 0;
+    std::string partial;        // Start of the line the last block ended in
+    std::string stragglers;     // Every line that crossed a block boundary
+    bool uring = false;
+    int error = 0;
+    {
+        salad::BlockReader reader(fd);
+        uring = reader.uses_uring();
+        for (std::string_view block; !(block = reader.next()).empty();) {
+            read_total += block.size();
+            const size_t first_end = block.find('\n');
+            if (first_end == std::string_view::npos) {
+                partial.append(block);
+                continue;
+            }
+            partial.append(block.substr(0, first_end + 1));
+            stragglers.append(partial);
+
+            const size_t last_end = block.rfind('\n');
+            add_run(block.substr(first_end + 1, last_end - first_end));
+            partial.assign(block.substr(last_end + 1));
+        }
+        error = reader.error();
+    }
+    if (!from_stdin) {
+        ::close(fd);
+    }
+    if (error != 0) {
+        pool.wait(sorting);
+        std::cerr << fmt::format("Failed to read the notes: {}\n", std::strerror(error));
+        return false;
+    }
+    stragglers.append(partial);
+    add_run(stragglers);
+    pool.wait(sorting);
+    salad::OutputSink::out().print(Verbosity::summary, "Read {} characters from file in {} sorted runs ({})\n\n",
+                                   read_total, runs.size(), uring ? "io_uring" : "reader thread");
+
+    size_t total = 0;
+    std::vector<size_t> bounds;
+    for (const auto& [run1, run2] : runs) {
+        bounds.push_back(total);
+        total += run1.size;
+    }
+    bounds.push_back(total);
+
+    note1 = Array<uint32_t>(total, salad::uninitialized);
+    note2 = Array<uint32_t>(total, salad::uninitialized);
+    for (size_t i = 0; i < runs.size(); i++) {
+        std::memcpy(note1.data + bounds[i], runs[i].first.data, runs[i].first.size * sizeof(uint32_t));
+        std::memcpy(note2.data + bounds[i], runs[i].second.data, runs[i].second.size * sizeof(uint32_t));
+    }
+    runs.clear();
+
+    merge_sorted_runs(note1, bounds, pool);
+    merge_sorted_runs(note2, bounds, pool);
+    return true;
+}
+
+// With --follow, a batch of new pairs is sorted in with everything else instead of inserted one pair at a
+// time once the ranks its insertions would have to sum again add up to this many times all the pairs
+constexpr size_t follow_rebuild_factor = 4;
+
+// How often a followed file is checked for new lines once everything in it has been read
+constexpr auto follow_poll_interval = std::chrono::milliseconds(250);
+
+// Set by SIGINT and SIGTERM while the notes are followed, the loop then stops and prints the totals
+volatile sig_atomic_t follow_stopped = 0;
+
+void stop_following(int) {
+    follow_stopped = 1;
+}
+
+// Incremental path: keeps reading the notes as they're appended (like tail -f) and updates both answers
+// after every batch of new lines. Regular files are followed until SIGINT or SIGTERM, pipes and stdin until
+// they end (or until either signal)
+int run_follow(const char* path, Array<uint32_t>& (*sorting_algo)(Array<uint32_t>&)) {
+    const bool from_stdin = std::string_view(path) == "-";
+    const int fd = from_stdin ? STDIN_FILENO : ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Failed to open file" << std::endl;
+        return 1;
+    }
+    const bool regular = S_ISREG(st.st_mode);
+    salad::OutputSink& out = salad::OutputSink::out();
+
+    salad::IncrementalNotes notes;
+    auto add_lines = [&](const std::string_view lines) {
+        const size_t line_count = salad::count_lines(lines);
+        // Appends are mostly a few lines, their columns are recycled by the pool
+        Array<uint32_t> new1 = Array<uint32_t>(line_count, salad::uninitialized, salad::pool_resource());
+        Array<uint32_t> new2 = Array<uint32_t>(line_count, salad::uninitialized, salad::pool_resource());
+        const size_t pairs = salad::parse_notes(lines, new1, new2);
+        if (pairs == 0) {
+            return;
+        }
+
+        // Inserting costs about the span of every pair, rebuilding about one pass over all of them (the old
+        // pairs are already sorted, which the adaptive sorts make short work of)
+        const size_t known = notes.size();
+        uint64_t span = 0;
+        for (size_t i = 0; i < pairs && known > 0; i++) {
+            span += notes.span(new1[i], new2[i]);
+        }
+        if (known == 0 || span > follow_rebuild_factor * (known + pairs)) {
+            Array<uint32_t> all1 = Array<uint32_t>(known + pairs, salad::uninitialized);
+            Array<uint32_t> all2 = Array<uint32_t>(known + pairs, salad::uninitialized);
+            notes.copy_to(all1.data, all2.data);
+            std::memcpy(all1.data + known, new1.data, pairs * sizeof(uint32_t));
+            std::memcpy(all2.data + known, new2.data, pairs * sizeof(uint32_t));
+            sorting_algo(all1);
+            sorting_algo(all2);
+            notes = salad::IncrementalNotes(all1, all2);
+        } else {
+            for (size_t i = 0; i < pairs; i++) {
+                notes.add(new1[i], new2[i]);
+            }
+        }
+        // Every batch is shown as soon as it's in, even when the output isn't a terminal. Regular files are
+        // followed until interrupted, so these lines are the answers and are printed even with --quiet
+        out.print(Verbosity::quiet, "{} pairs (+{}): sum of differences {:d}, similarity score {:d}\n",
+                  notes.size(), pairs, notes.distance(), notes.similarity());
+        out.flush();
+    };
+
+    // Without SA_RESTART a read blocked on a pipe returns with EINTR, so the signal is seen right away. The
+    // previous handlers are back once the loop is done
+    struct sigaction stop{};
+    stop.sa_handler = stop_following;
+    sigemptyset(&stop.sa_mask);
+    struct sigaction previous_int{};
+    struct sigaction previous_term{};
+    follow_stopped = 0;
+    sigaction(SIGINT, &stop, &previous_int);
+    sigaction(SIGTERM, &stop, &previous_term);
+
+    constexpr size_t read_size = 1 << 20;
+    std::string pending;
+    int error = 0;
+    while (true) {
+        // Reads that come back full mean there's more waiting, so all of it goes into one batch
+        ssize_t got;
+        do {
+            const size_t filled = pending.size();
+            pending.resize(filled + read_size);
+            got = ::read(fd, pending.data() + filled, read_size);
+            pending.resize(filled + (got > 0 ? got : 0));
+        } while (got == static_cast<ssize_t>(read_size) || (got < 0 && errno == EINTR && !follow_stopped));
+        if (got < 0 && !follow_stopped) {
+            error = errno;
+            break;
+        }
+
+        // A line is only used once its newline is there, unless the input has ended for good (or following
+        // was stopped, then a last line without its newline counts as well)
+        const bool ended = (got == 0 && !regular) || follow_stopped;
+        const size_t usable = ended ? pending.size() : pending.rfind('\n') + 1;
+        if (usable > 0) {
+            add_lines(std::string_view(pending.data(), usable));
+            pending.erase(0, usable);
+        }
+
+        if (ended) {
+            break;
+        }
+        if (got == 0) {
+            std::this_thread::sleep_for(follow_poll_interval);
+        }
+    }
+    sigaction(SIGINT, &previous_int, nullptr);
+    sigaction(SIGTERM, &previous_term, nullptr);
+
+    if (!from_stdin) {
+        ::close(fd);
+    }
+    if (error != 0) {
+        std::cerr << fmt::format("Failed to read the notes: {}\n", std::strerror(error));
+        return 1;
+    }
+    out.print(Verbosity::quiet, "Sum of differences of location identifiers: {:d}\n", notes.distance());
+    out.print(Verbosity::quiet, "Similarity score: {:d}\n\n", notes.similarity());
+    return 0;
+}
+
+// With --batch, a file is read with one read() into a buffer this much larger than its size, so the read that
+// comes back empty confirms the end without another round of growing
+constexpr size_t batch_read_slack = 4096;
+
+// Grows a per-thread buffer to hold at least size elements, keeping the first keep of them
+template<typename T>
+void ensure_capacity(Array<T>& buffer, const size_t size, const size_t keep = 0) {
+    if (buffer.capacity >= size) {
+        buffer.size = size;
+        return;
+    }
+    Array<T> grown = Array<T>(std::max(size, buffer.capacity * 2), salad::uninitialized);
+    if (keep > 0) {
+        std::memcpy(grown.data, buffer.data, keep * sizeof(T));
+    }
+    grown.size = size;
+    buffer = std::move(grown);
+}
+
+struct BatchResult {
+    std::string path;
+    size_t pairs = 0;
+    uint64_t distance = 0;
+    uint64_t similarity = 0;
+    int error = 0;      // errno of a failed open or read, 0 if both answers are in
+};
+
+// Both answers for one file of a batch. Every pool thread keeps its buffers for the next file it gets, so after
+// the first few files a batch stops allocating for anything but the sorts' own temporaries
+void batch_file(BatchResult& result, Array<uint32_t>& (*sorting_algo)(Array<uint32_t>&)) {
+    thread_local Array<char> text = Array<char>(nullptr, 0, false);
+    thread_local Array<uint32_t> note1 = Array<uint32_t>(nullptr, 0, false);
+    thread_local Array<uint32_t> note2 = Array<uint32_t>(nullptr, 0, false);
+
+    const int fd = ::open(result.path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        result.error = errno;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return;
+    }
+
+    // Pipes and other files without a size are read until they end all the same
+    size_t filled = 0;
+    ensure_capacity(text, static_cast<size_t>(std::max<off_t>(st.st_size, 0)) + batch_read_slack);
+    while (true) {
+        if (filled == text.size) {
+            ensure_capacity(text, text.size * 2, filled);
+        }
+        const ssize_t got = ::read(fd, text.data + filled, text.size - filled);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            result.error = errno;
+            ::close(fd);
+            return;
+        }
+        if (got == 0) {
+            break;
+        }
+        filled += got;
+    }
+    ::close(fd);
+
+    const std::string_view lines(text.data, filled);
+    const size_t line_count = salad::count_lines(lines);
+    ensure_capacity(note1, line_count);
+    ensure_capacity(note2, line_count);
+    const size_t pairs = salad::parse_notes(lines, note1, note2);
+
+    // Views of the scratch columns, so the sorts see exactly the parsed pairs and never free the buffers
+    Array<uint32_t> column1 = Array<uint32_t>(note1.data, pairs, false);
+    Array<uint32_t> column2 = Array<uint32_t>(note2.data, pairs, false);
+    sorting_algo(column1);
+    sorting_algo(column2);
+
+    result.pairs = pairs;
+    result.distance = salad::abs_diff_sum<uint32_t>(column1, column2);
+    result.similarity = salad::similarity_join<uint32_t>(column1, column2);
+}
+
+// Paths of a batch: the files in a directory (by name, subdirectories aren't entered), or the lines of a list
+// file ("-" reads the list from stdin). Empty if spec can't be read
+std::vector<std::string> batch_paths(const std::string& spec) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    if (std::filesystem::is_directory(spec, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(spec, error)) {
+            if (!entry.is_directory(error)) {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::ifstream list_file;
+    if (spec != "-") {
+        list_file.open(spec);
+        if (!list_file) {
+            return paths;
+        }
+    }
+    std::istream& list = spec == "-" ? std::cin : list_file;
+    for (std::string line; std::getline(list, line);) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            paths.push_back(std::move(line));
+        }
+    }
+    return paths;
+}
+
+// Quotes a CSV field when it has to be
+std::string csv_field(const std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        return std::string(field);
+    }
+    std::string quoted = "\"";
+    for (const char c : field) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + '"';
+}
+
+// A JSON string literal for text
+std::string json_string(const std::string_view text) {
+    std::string quoted = "\"";
+    for (const char c : text) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\r': quoted += "\\r"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    quoted += fmt::format("\\u{:04x}", c);
+                } else {
+                    quoted += c;
+                }
+        }
+    }
+    return quoted + '"';
+}
+
+// Batch path for many small inputs: every file of the batch is parsed, sorted and answered on its own pool
+// thread, without the self-tests. The results come out in the order of the paths as CSV (one line per file
+// and a last "total" line) or as one JSON document
+int run_batch(const std::string& spec, const bool json, Array<uint32_t>& (*sorting_algo)(Array<uint32_t>&)) {
+    std::vector<BatchResult> results;
+    for (std::string& path : batch_paths(spec)) {
+        results.push_back(BatchResult{std::move(path)});
+    }
+    if (results.empty()) {
+        std::cerr << fmt::format("No notes to process in {}\n", spec);
+        return 1;
+    }
+
+    salad::ThreadPool::global().parallel_for(0, results.size(), 1, [&](const size_t first, const size_t last) {
+        for (size_t i = first; i < last; i++) {
+            batch_file(results[i], sorting_algo);
+        }
+    });
+
+    BatchResult total{"total"};
+    size_t failed = 0;
+    for (const BatchResult& result : results) {
+        total.pairs += result.pairs;
+        total.distance += result.distance;
+        total.similarity += result.similarity;
+        failed += result.error != 0;
+    }
+
+    std::string report;
+    if (json) {
+        report += "{\"files\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BatchResult& result = results[i];
+            report += fmt::format("  {{\"path\": {}, ", json_string(result.path));
+            if (result.error != 0) {
+                report += fmt::format("\"error\": {}}}", json_string(std::strerror(result.error)));
+            } else {
+                report += fmt::format("\"pairs\": {}, \"distance\": {}, \"similarity\": {}}}", result.pairs,
+                                   result.distance, result.similarity);
+            }
+            report += i + 1 < results.size() ? ",\n" : "\n";
+        }
+        report += fmt::format("], \"total\": {{\"files\": {}, \"failed\": {}, \"pairs\": {}, \"distance\": {}, "
+                           "\"similarity\": {}}}}}\n", results.size(), failed, total.pairs, total.distance,
+                           total.similarity);
+    } else {
+        report += "path,pairs,distance,similarity,error\n";
+        results.push_back(std::move(total));
+        for (const BatchResult& result : results) {
+            if (result.error != 0) {
+                report += fmt::format("{},,,,{}\n", csv_field(result.path), csv_field(std::strerror(result.error)));
+            } else {
+                report += fmt::format("{},{},{},{},\n", csv_field(result.path), result.pairs, result.distance,
+                                   result.similarity);
+            }
+        }
+    }
+    salad::OutputSink::out().write(Verbosity::quiet, report);
+    return failed > 0 ? 1 : 0;
+}
 
 int sorting_check(Array<int32_t>& (*sorting_algo)(Array<int32_t>&)) {
     int32_t arr_data[10] = {7, 5, -8, 9, 0, 6, 1, -8, 0, -10};
     Array<int32_t> arr = Array<int32_t>::from(arr_data, sizeof(arr_data) / sizeof(int32_t));
 
-    std::string arr_size_str = salad::format_color("{" + salad::itos(arr.size) + ":f cyan}");
-    std::cout << fmt::format("..:: Unsorted Array [{}] ::..", arr_size_str) << std::endl;
+    salad::OutputSink& out = salad::OutputSink::out();
+    out.render(Verbosity::verbose, [&arr](const auto it) {
+        salad::color_format<"..:: Unsorted Array [{:f cyan}] ::..\n">.format_to(it, arr.size);
+    });
     for (int i = 0; i < arr.size; i++) {
-        std::cout << fmt::format("{:+d} ", arr[i]);
+        out.print(Verbosity::verbose, "{:+d} ", arr[i]);
     }
-    std::cout << std::endl;
+    out.print(Verbosity::verbose, "\n");
 
-    Array<int32_t> sorted = sorting_algo(arr);
-    arr_size_str = salad::format_color("{" + salad::itos(sorted.size) + ":f cyan}");
-    std::cout << fmt::format("..:: Sorted Array [{}] ::..", arr_size_str) << std::endl;
+    Array<int32_t>& sorted = sorting_algo(arr);
+    out.render(Verbosity::verbose, [&sorted](const auto it) {
+        salad::color_format<"..:: Sorted Array [{:f cyan}] ::..\n">.format_to(it, sorted.size);
+    });
     // Copy the array to avoid modifying the original
     for (int32_t* p = sorted.data; p != sorted.data + sorted.size; p++) {
-        std::cout << fmt::format("{:+d} ", *p);
+        out.print(Verbosity::verbose, "{:+d} ", *p);
         if (p != sorted.data && *p < *(p-1)) {
             return 1;
         }
     }
-    std::cout << std::endl;
+    out.print(Verbosity::verbose, "\n");
     
     return 0;
 }
 
+// similarity_histogram has to agree with the merge join on the sorted columns, whether b's values fit the
+// counting array or spread too far for it and get hashed
+int join_check() {
+    auto agrees = []<typename T>(std::vector<T> a, std::vector<T> b) {
+        const salad::ArrayView<T> view1{a.data(), a.size()};
+        const salad::ArrayView<T> view2{b.data(), b.size()};
+        const uint64_t histogram = salad::similarity_histogram<T>(view1, view2);
+
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return histogram == salad::similarity_join<T>(view1, view2);
+    };
+
+    const bool counted = agrees(std::vector<uint32_t>{3, 4, 2, 1, 3, 3}, std::vector<uint32_t>{4, 3, 5, 3, 9, 3}) &&
+                         agrees(std::vector<int32_t>{-2, 7, -2, 0}, std::vector<int32_t>{-2, -2, 7, 1});
+    const bool hashed = agrees(std::vector<uint32_t>{4000000000, 7, 7, 12, 4000000000},
+                               std::vector<uint32_t>{7, 4000000000, 1, 7, 4000000000, 4000000000, 12});
+
+    salad::OutputSink& out = salad::OutputSink::out();
+    out.print(Verbosity::verbose, "..:: Join Test ::..\n");
+    out.print(Verbosity::verbose, "Histogram matches merge join: {}\n", counted);
+    out.print(Verbosity::verbose, "Histogram matches merge join past the counting range: {}\n", hashed);
+    return counted && hashed ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
-    std::cout << fmt::format("<< Array Utility Test >>\n");
-    if (const int res=salad::test() != 0) {
-        return res;
+    // Flags can go anywhere, the rest is positional: [notes file] [sorting algorithm], or only [sorting algorithm]
+    // with --batch
+    std::vector<std::string_view> args;
+    bool dump_counters = false;
+    // --mem <size> caps the memory the columns may take and sorts them out of core, --tmp <dir> is where
+    // the runs go (the default is $TMPDIR or /tmp)
+    size_t memory_budget = 0;
+    std::string tmp_dir;
+    // --cache <file> keeps the parsed and sorted columns there, later runs on the same input map them instead
+    std::string cache_path;
+    // --follow keeps reading the notes as lines are appended and updates the answers after every batch
+    bool follow = false;
+    // --pipeline overlaps reading the notes with parsing and sorting them, block by block
+    bool pipeline = false;
+    // --batch <dir|list> answers every file in a directory or listed in a file (one path per line, "-" for stdin)
+    // at once, as CSV or with --format json as JSON
+    std::string batch_spec;
+    bool batch_json = false;
+    // --summary leaves out the self-tests and the line per matched value, --quiet prints the answers only
+    salad::OutputSink& out = salad::OutputSink::out();
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--counters") {
+            dump_counters = true;
+        } else if (arg == "--mem" && i + 1 < argc) {
+            memory_budget = parse_size(argv[++i]);
+            if (memory_budget == 0) {
+                std::cerr << fmt::format("Invalid memory budget: {}\n", argv[i]);
+                return 1;
+            }
+            if (memory_budget < external_min_budget) {
+                std::cerr << fmt::format("The memory budget has to be at least {}K\n", external_min_budget >> 10);
+                return 1;
+            }
+        } else if (arg == "--tmp" && i + 1 < argc) {
+            tmp_dir = argv[++i];
+        } else if (arg == "--follow") {
+            follow = true;
+        } else if (arg == "--pipeline") {
+            pipeline = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch_spec = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            const std::string_view format = argv[++i];
+            if (format != "csv" && format != "json") {
+                std::cerr << fmt::format("Invalid batch format: {}\n", format);
+                return 1;
+            }
+            batch_json = format == "json";
+        } else if (arg == "--summary") {
+            out.set_verbosity(Verbosity::summary);
+        } else if (arg == "--quiet") {
+            out.set_verbosity(Verbosity::quiet);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
     }
-    std::cout << fmt::format("<< ------------------ >>\n") << std::endl;
-    
-    std::cout << fmt::format("<< Sorting Algorithm Test >>\n");
 
-    // If there's a second argument, check if it's 'merge_sort', 'imerge_sort', or 'insertion_sort'
+    // A batch only prints its results, the self-tests are for interactive runs
+    const bool batch = !batch_spec.empty();
+    if (!batch && out.enabled(Verbosity::verbose)) {
+        out.print(Verbosity::verbose, "<< Array Utility Test >>\n");
+        // The array test prints through std::cout, so everything before it has to be out first
+        out.flush();
+        if (const int res=salad::test() != 0) {
+            return res;
+        }
+        out.print(Verbosity::verbose, "<< ------------------ >>\n\n");
+
+        out.print(Verbosity::verbose, "<< Sorting Algorithm Test >>\n");
+    }
+
+    const size_t sort_arg = batch ? 0 : 1;
+    // If there's a sorting algorithm argument, check if it's 'auto', 'merge_sort', 'imerge_sort', 'pmerge_sort',
+    // 'nmerge_sort', 'insertion_sort', or 'radix_sort'
     Array<uint32_t>& (*usorting_algo)(Array<uint32_t>&) = nullptr;
     Array<int32_t>& (*isorting_algo)(Array<int32_t>&) = nullptr;
-    if (argc > 2) {
-        if (std::string(argv[2]) == "merge_sort") {
+    bool autotuned = false;
+    if (args.size() > sort_arg) {
+        if (args[sort_arg] == "auto") {
+            autotuned = true;
+            usorting_algo = salad::autotune::sort<uint32_t>;
+            isorting_algo = salad::autotune::sort<int32_t>;
+        } else if (args[sort_arg] == "merge_sort") {
             usorting_algo = salad::merge_sort<uint32_t>;
             isorting_algo = salad::merge_sort<int32_t>;
-        } else if (std::string(argv[2]) == "insertion_sort") {
+        } else if (args[sort_arg] == "insertion_sort") {
             usorting_algo = salad::insertion_sort<uint32_t>;
             isorting_algo = salad::insertion_sort<int32_t>;
-        } else if (std::string(argv[2]) == "imerge_sort") {
-            usorting_algo = salad::merge_sort_iterative<uint32_t, 32>;
-            isorting_algo = salad::merge_sort_iterative<int32_t, 32>;
+        } else if (args[sort_arg] == "imerge_sort") {
+            usorting_algo = salad::merge_sort_iterative<uint32_t>;
+            isorting_algo = salad::merge_sort_iterative<int32_t>;
+        } else if (args[sort_arg] == "pmerge_sort") {
+            usorting_algo = salad::parallel_merge_sort_iterative<uint32_t>;
+            isorting_algo = salad::parallel_merge_sort_iterative<int32_t>;
+        } else if (args[sort_arg] == "nmerge_sort") {
+            usorting_algo = salad::natural_merge_sort<uint32_t>;
+            isorting_algo = salad::natural_merge_sort<int32_t>;
+        } else if (args[sort_arg] == "radix_sort") {
+            usorting_algo = salad::radix_sort<uint32_t>;
+            isorting_algo = salad::radix_sort<int32_t>;
         }
     }
     if (usorting_algo == nullptr || isorting_algo == nullptr) {
-        std::cerr << fmt::format("Invalid sorting algorithm specified\nDefaulting to recursive merge_sort\n") << std::endl;
-        usorting_algo = salad::merge_sort<uint32_t>;
-        isorting_algo = salad::merge_sort<int32_t>;
-    } else {
-        std::cout << fmt::format("Using sorting algorithm: {}\n", argv[2]) << std::endl;
+        if (!batch || args.size() > sort_arg) {
+            std::cerr << fmt::format("Invalid sorting algorithm specified\nDefaulting to auto\n") << std::endl;
+        }
+        autotuned = true;
+        usorting_algo = salad::autotune::sort<uint32_t>;
+        isorting_algo = salad::autotune::sort<int32_t>;
+    } else if (!batch) {
+        out.print(Verbosity::summary, "Using sorting algorithm: {}\n\n", args[sort_arg]);
+    }
+
+    if (batch) {
+        return run_batch(batch_spec, batch_json, usorting_algo);
     }
 
     if (const int res=sorting_check(isorting_algo); res) {
         return res;
     }
-    char* locs_path = argv[1];
-    std::cout << fmt::format("<< ---------------------- >>\n", locs_path) << std::endl;
+    // Like the array test, only part of the demo output
+    if (out.enabled(Verbosity::verbose)) {
+        if (const int res=join_check(); res) {
+            return res;
+        }
+    }
+    // No path (or "-") reads the notes from stdin
+    const char* locs_path = !args.empty() ? args[0].data() : "-";
+    out.print(Verbosity::verbose, "<< ---------------------- >>\n\n");
+
+    if (follow) {
+        return run_follow(locs_path, usorting_algo);
+    }
+    if (memory_budget > 0) {
+        return run_external(locs_path, memory_budget, tmp_dir, usorting_algo);
+    }
     
-    std::ifstream locs;
-    // Open the file and scan to the end to get the size
-    locs.open(locs_path, std::ios::in | std::ios::ate);
-    if (!locs.is_open()) {
+    salad::ThreadPool& pool = salad::ThreadPool::global();
+    Array<uint32_t> note1 = Array<uint32_t>(nullptr, 0, false);
+    Array<uint32_t> note2 = Array<uint32_t>(nullptr, 0, false);
+
+    salad::InputSource locs;
+    if (pipeline) {
+        // The columns come out sorted, and the input is never whole in memory to hash for a cache
+        if (!read_pipelined(locs_path, usorting_algo, pool, note1, note2)) {
+            return 1;
+        }
+        cache_path.clear();
+    } else if (!locs.open(locs_path)) {
+        // Regular files are mapped straight into memory, pipes and stdin are read in chunks
         std::cerr << "Failed to open file" << std::endl;
         return 1;
+    } else {
+        out.print(Verbosity::summary, "Read {} characters from file\n\n", locs.size);
     }
-    // Get the size of the file using the current position
-    std::streamsize size = locs.tellg();
-    locs.seekg(0, std::ios::beg);
-    // Store the file contents in a buffer
-    char data[size];
-    locs.read(data, size);
-    locs.close();
-    
-    std::cout << fmt::format("Read {} characters from file\n", size) << std::endl;
 
-    uint8_t line_len = 0;
-    for (const char c : data) {
-        if (c == '\n') {
-            break;
-        }
-        line_len++;
+    // A cache only matches the input it was made from, whose size and hash are compared before anything is used
+    const uint64_t input_hash = cache_path.empty() ? 0 : salad::content_hash(locs.view());
+    salad::NoteCache cache;
+    if (!cache_path.empty() && cache.open(cache_path.c_str(), input_hash, locs.size)) {
+        note1 = cache.note1();
+        note2 = cache.note2();
+        out.print(Verbosity::summary, "Loaded {} {} pairs from {}\n\n", cache.size(),
+                  cache.sorted() ? "sorted" : "unsorted", cache_path);
+    } else if (!pipeline) {
+        // The input is split at line boundaries into chunks that are counted and parsed in parallel.
+        // Size the columns by the exact line count, lines don't have to share the same length
+        const salad::NoteLayout layout = salad::layout_notes(locs.view(), pool);
+        const size_t line_count = layout.lines();
+
+        // Multi-GB columns go on huge pages to save TLB misses during the sorts.
+        // The parser writes every element that's kept, so there's no need to zero them first
+        std::pmr::memory_resource* column_resource = line_count * sizeof(uint32_t) >= huge_page_threshold
+            ? salad::huge_page_resource() : nullptr;
+        note1 = Array<uint32_t>(line_count, salad::uninitialized, column_resource);
+        note2 = Array<uint32_t>(line_count, salad::uninitialized, column_resource);
+
+        // Blank or incomplete lines are skipped, so only keep the pairs that were actually parsed
+        const size_t pairs = salad::parse_notes(layout, note1, note2, pool);
+        note1.size = pairs;
+        note2.size = pairs;
     }
-    uint32_t line_count = size / (line_len+1);
-    
-    Array<uint32_t> note1 = Array<uint32_t>(line_count);
-    Array<uint32_t> note2 = Array<uint32_t>(line_count);
 
-    uint32_t* note1_caret = note1.data;
-    uint32_t* note2_caret = note2.data;
-    char* num_buffer = new char[line_len];
-    size_t i = 0;
-    uint8_t j = 0;
-    for (char* caret = data; caret != data + size; caret++) {
-        bool numeric = *caret >= '0' && *caret <= '9';
-        bool last_iter = caret == data + size - 1;
-        if (!numeric || last_iter) {
-            num_buffer[j] = '\0';
-            if (j == 0) {
-                continue;
-            }
-            j = 0;
-            *(i++ % 2 == 0 ? note1_caret++ : note2_caret++) = salad::stoi<uint32_t>(num_buffer);
-            
-           continue; 
+    if (!pipeline && !cache.sorted()) {
+        // The autotuner samples every column on its own, so the choices are picked here to report them
+        if (autotuned && out.enabled(Verbosity::summary)) {
+            const salad::CacheInfo& caches = salad::cache_info();
+            out.print(Verbosity::summary, "Caches: L1d {} KiB, L2 {} KiB, L3 {} KiB\n", caches.l1d >> 10, caches.l2 >> 10,
+                      caches.l3 >> 10);
+            out.print(Verbosity::summary, "Autotuner picked {} for note1 and {} for note2\n\n",
+                      salad::autotune::choose(note1.view()).name, salad::autotune::choose(note2.view()).name);
         }
 
-        num_buffer[j++] = *caret;
-        j %= line_len;
+        // Both location notes are independent, so sort them at the same time
+        salad::ThreadPool::TaskGroup sorting;
+        pool.run(sorting, [&] { usorting_algo(note1); });
+        pool.run(sorting, [&] { usorting_algo(note2); });
+        pool.wait(sorting);
+
+        if (!cache_path.empty()) {
+            if (salad::NoteCache::write(cache_path.c_str(), input_hash, locs.size, note1, note2, true)) {
+                out.print(Verbosity::summary, "Saved the sorted columns to {}\n\n", cache_path);
+            } else {
+                std::cerr << fmt::format("Failed to write the cache {}: {}\n", cache_path, std::strerror(errno));
+            }
+        }
     }
 
-    note1 = salad::merge_sort_iterative<uint32_t>(note1);
+    // Vectorized, and split between the threads for long columns, so this runs at memory bandwidth
+    const uint64_t diffs = salad::abs_diff_sum<uint32_t>(note1, note2, pool);
 
-    // Sort the second location notes
-    note2 = salad::merge_sort_iterative<uint32_t>(note2);
-    
-    uint64_t diffs = 0;
+    // Both notes are sorted, so a single merge-join pass counts how often every shared value occurs on each side
     uint64_t similarity = 0;
-
-    auto binary_search = salad::binary_search<uint32_t, size_t>;
-
-    // Copy
-    Array<uint32_t> note2_view = Array<uint32_t>::from(note2.data, note2.size);
-
-    for (uint32_t* p1 = note1.data, *p2 = note2.data; p1 != note1.data + note1.size; p1++, p2++) {
-        uint32_t l = *p1;
-        uint32_t r = *p2;
-        diffs += l > r ? l - r : r - l;
-        
-        // Find n occurrences of l in note2, both are sorted so binary search(note2, l) - binary search(note2, l+1) gives the number of occurrences
-        size_t r_start = binary_search(note2_view, l);
-        note2_view = note2_view[{r_start, note2_view.size}];
-        size_t r_end = binary_search(note2_view, l+1);
-        size_t n = r_end; // - r_start (omitted because r_start is always 0 in this case)
-        similarity += l * n;
-        if (n > 0)
-            std::cout << fmt::format("{:d} appears {:d} times in note2\n", l, n);
-        if (r_end < note2_view.size)
-            note2_view = note2_view[{r_end, note2_view.size}];   // << SLICING, Fk yeah
-    }
-    std::cout << std::endl;
+    salad::merge_join<uint32_t>(note1, note2, [&](const uint32_t l, const size_t n1, const size_t n2) {
+        similarity += static_cast<uint64_t>(l) * n1 * n2;
+        for (size_t k = 0; k < n1 && out.enabled(Verbosity::verbose); k++) {
+            out.print(Verbosity::verbose, "{:d} appears {:d} times in note2\n", l, n2);
+        }
+    });
+    out.print(Verbosity::verbose, "\n");
 
     
-    std::cout << fmt::format("Sum of differences of location identifiers: {:d}\n", diffs);
-    std::cout << fmt::format("Similarity score: {:d}\n", similarity) << std::endl;
+    out.print(Verbosity::quiet, "Sum of differences of location identifiers: {:d}\n", diffs);
+    out.print(Verbosity::quiet, "Similarity score: {:d}\n\n", similarity);
 
-    std::cout << fmt::format("We have copied {} bytes of the array, which is enough for {} int32's\n", salad::copies, salad::copies / sizeof(uint32_t)) << std::endl;
-    delete[] num_buffer;
+    const uint64_t copied = salad::instrument::read(salad::instrument::Counter::bytes_copied);
+    out.print(Verbosity::summary, "We have copied {} bytes of the array, which is enough for {} int32's\n\n", copied,
+              copied / sizeof(uint32_t));
+    if (dump_counters) {
+        out.print(Verbosity::quiet, "{}\n", salad::instrument::to_json());
+    }
     return 0;
 }
@@ -5,50 +5,47 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#include <algorithm>
 #include <iostream>
-#include <stdexcept>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <fmt/format.h>
 #include "arr_util.h"
+#include "instrument.h"
+#include "int_conv.h"
+#include "memory.h"
+#include "simd_merge.h"
+#include "sort_network.h"
+#include "thread_pool.h"
 
 namespace salad {
+    // The whole of str as an int_t in base (2 to 36), nullopt if it's empty, has anything but digits (after an
+    // optional '-') or doesn't fit
     template<typename int_t = int32_t>
-    int_t stoi (const std::string &str, const unsigned short base = 10) {
-        int_t num = 0;
-        bool negative = str[0] == '-';
-        
-        for (char* caret = const_cast<char*>(str.c_str()) + negative; *caret != '\0'; caret++) {
-            char& c = *caret;
-            if (c >= 'a' && c <= 'z') {
-                c ^= 0x20;
-            }
-            
-            if (c < '0' || (c > '9' && c < 'A')) {
-                throw std::invalid_argument("invalid argument");
-            }
-            num = num * base + (c - (c <= '9' ? '0' : 'A' - 10)); 
+    std::optional<int_t> stoi (const std::string_view str, const unsigned short base = 10) {
+        int_t num;
+        const ParseResult result = parse_int(str, num, base);
+        if (result.ec != std::errc{} || result.ptr != str.data() + str.size()) {
+            return std::nullopt;
         }
-        return num * (negative ? -1 : 1);
+        return num;
     }
 
     template<typename int_t = int32_t>
-    std::string itos (int_t num, const unsigned short base = 10) {
-        std::string str{};
-        while (num) {
-            str.push_back(num % base + (num % base < 10 ? '0' : 'A' - 10));
-            num /= base;
-        }
-
-        for (size_t i = 0; i < str.size() / 2; i++) {
-            std::swap(str[i], str[str.size() - i - 1]);
-        }
-        return str;
+    std::string itos (const int_t num, const unsigned short base = 10) {
+        char buffer[max_chars<int_t>];
+        const FormatResult result = format_int(buffer, buffer + sizeof(buffer), num, base);
+        return {buffer, result.ptr};
     }
 
     template<typename T = int32_t, typename U = int64_t>
-    U binary_search (const Array<T>& arr, T val) {
+    U binary_search (const ArrayView<T> arr, T val) {
         int64_t left = 0;
         int64_t right = arr.size;
+        uint64_t comparisons = 0;
         while (left < right) {
             // Avoid overflow
             int64_t mid = left + (right - left) / 2;
@@ -57,12 +54,46 @@ namespace salad {
             } else {
                 right = mid;
             }
+            comparisons++;
         }
+        instrument::add(instrument::Counter::comparisons, comparisons);
         return left;
     }
     
+    // Temporaries up to this size come from the pool, they're too small for an arena block to pay off
+    constexpr size_t pooled_scratch_limit = 64 << 10;
+
+    // Sort scratch of size elements: small temporaries are recycled by the pool, larger ones are carved out of
+    // this thread's arena while a ScratchScope is open (and come from the default resource otherwise)
+    template<typename T>
+    Array<T> scratch_array (const size_t size) {
+        if (sizeof(T) * size <= pooled_scratch_limit) {
+            return Array<T>(size, uninitialized, pool_resource());
+        }
+        return Array<T>(size, uninitialized, ScratchScope::active() ? &scratch_arena() : nullptr);
+    }
+
+    // Same-width fixed integer type the vector merge kernels are instantiated for
+    template<typename T>
+    using simd_key_t = std::conditional_t<sizeof(T) == 4,
+                                          std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>,
+                                          std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
     template<typename T = int32_t>
-    Array<T>& merge (const Array<T>& a, const Array<T>& b, Array<T>& out) {
+    ArrayView<T> merge (const ArrayView<T> a, const ArrayView<T> b, const ArrayView<T> out) {
+        if constexpr (std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)) {
+            if (a.size >= simd::merge_min_run && b.size >= simd::merge_min_run) {
+                using key_t = simd_key_t<T>;
+                if (simd::merge(reinterpret_cast<const key_t*>(a.data), a.size,
+                                reinterpret_cast<const key_t*>(b.data), b.size,
+                                reinterpret_cast<key_t*>(out.data))) {
+                    instrument::add(instrument::Counter::comparisons, a.size + b.size);
+                    instrument::add(instrument::Counter::moves, a.size + b.size);
+                    return out;
+                }
+            }
+        }
+
         T* res_caret = out.data;
 
         const T* a_end = a.data + a.size;
@@ -70,18 +101,19 @@ namespace salad {
 
         const T* a_caret = a.data;
         const T* b_caret = b.data;
+        // Branchless: both carets advance by the outcome of the comparison, ties take from a (stable)
         for (; a_caret != a_end && b_caret != b_end; res_caret++) {
-            int32_t l = *a_caret;
-            int32_t r = *b_caret;
-            if (l < r) {
-                *res_caret = l;
-                a_caret++;
-            } else {
-                *res_caret = r;
-                b_caret++;
-            }
+            const T l = *a_caret;
+            const T r = *b_caret;
+            const bool take_b = r < l;
+            *res_caret = take_b ? r : l;
+            a_caret += !take_b;
+            b_caret += take_b;
         }
 
+        instrument::add(instrument::Counter::comparisons, res_caret - out.data);
+        instrument::add(instrument::Counter::moves, a.size + b.size);
+
         // Copy the remaining elements (the finished loop won't run because one of the arrays is empty)
         for (; a_caret != a_end; a_caret++, res_caret++) {
             *res_caret = *a_caret;
@@ -93,75 +125,611 @@ namespace salad {
         return out;
     }
 
+    // Sorts into using from as scratch, both have to hold the same elements.
+    // Every level merges from one buffer into the other, so nothing is copied on the way down
+    template<typename T = int32_t>
+    void merge_sort_split (const ArrayView<T> from, const ArrayView<T> into) {
+        if (into.size <= 1) {
+            return;
+        }
+
+        const size_t mid = into.size / 2;
+        // Sort the halves of from, using the halves of into as their scratch
+        merge_sort_split(into[{0, mid}], from[{0, mid}]);
+        merge_sort_split(into[{mid, into.size}], from[{mid, from.size}]);
+        merge<T>(from[{0, mid}], from[{mid, from.size}], into);
+    }
+
+    // scratch has to hold at least arr.size elements, a smaller one is replaced by a temporary
+    template<typename T = int32_t>
+    ArrayView<T> merge_sort (const ArrayView<T> arr, const ArrayView<std::type_identity_t<T>> scratch) {
+        if (arr.size <= 1) {
+            return arr;
+        }
+        if (scratch.size < arr.size) {
+            ScratchScope scope;
+            Array<T> buffer = scratch_array<T>(arr.size);
+            return merge_sort<T>(arr, buffer);
+        }
+
+        // The only copy of the whole sort
+        const ArrayView<T> from = scratch[{0, arr.size}];
+        std::memcpy(from.data, arr.data, sizeof(T) * arr.size);
+        instrument::add(instrument::Counter::bytes_copied, sizeof(T) * arr.size);
+
+        merge_sort_split(from, arr);
+        return arr;
+    }
+
     template<typename T = int32_t>
     Array<T>& merge_sort (Array<T>& arr) {
+        ScratchScope scope;
+        Array<T> scratch = scratch_array<T>(arr.size);
+        merge_sort<T>(arr, scratch);
+        return arr;
+    }
+
+    // Number of elements of the sorted arr[0, size) that go before val: the ones less than it, with Upper also
+    // the ones equal to it. Probes 1, 3, 7, ... elements in from the front, so a small answer k costs O(log k)
+    template<bool Upper, typename T>
+    size_t gallop_front (const T* arr, const size_t size, const T& val) {
+        size_t comparisons = 0;
+        auto before = [&](const T& x) { comparisons++; return Upper ? !(val < x) : x < val; };
+        if (size == 0 || !before(arr[0])) {
+            instrument::add(instrument::Counter::comparisons, comparisons);
+            return 0;
+        }
+
+        size_t count = 1;
+        size_t step = 1;
+        while (count + step <= size && before(arr[count + step - 1])) {
+            count += step;
+            step *= 2;
+        }
+
+        size_t lo = count;
+        size_t hi = count + step - 1 < size ? count + step - 1 : size;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (before(arr[mid])) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        instrument::add(instrument::Counter::comparisons, comparisons);
+        return lo;
+    }
+
+    // Same count as gallop_front, probing from the back, so it's cheap when few elements go after val
+    template<bool Upper, typename T>
+    size_t gallop_back (const T* arr, const size_t size, const T& val) {
+        size_t comparisons = 0;
+        auto after = [&](const T& x) { comparisons++; return Upper ? val < x : !(x < val); };
+        if (size == 0 || !after(arr[size - 1])) {
+            instrument::add(instrument::Counter::comparisons, comparisons);
+            return size;
+        }
+
+        size_t count = 1;
+        size_t step = 1;
+        while (count + step <= size && after(arr[size - count - step])) {
+            count += step;
+            step *= 2;
+        }
+
+        size_t lo = count + step > size ? 0 : size - count - step + 1;
+        size_t hi = size - count;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (after(arr[mid])) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        instrument::add(instrument::Counter::comparisons, comparisons);
+        return lo;
+    }
+
+    // The first sorted elements have to be in order already
+    template<typename T = int32_t>
+    ArrayView<T> insertion_sort (const ArrayView<T> arr, const size_t sorted = 1) {
         if (arr.size <= 1) {
             return arr;
         }
 
-        Array<T> arr_cpy = Array<T>(arr);
-        Array<T> left = arr_cpy[{0, arr.size / 2}];
-        left = merge_sort(left);
-        Array<T> right = arr_cpy[{arr.size / 2, arr.size}];
-        right = merge_sort(right);
-        merge<T>(left, right, arr);
+        // Shifting while scanning back stops after any equal elements, so the sort is stable, and costs a
+        // single comparison for an element that's already in place
+        size_t moves = 0;
+        size_t comparisons = 0;
+        for (size_t i = sorted > 1 ? sorted : 1; i < arr.size; i++) {
+            const T key = arr[i];
+            size_t j = i;
+            for (; j > 0 && key < arr[j - 1]; j--) {
+                arr[j] = arr[j - 1];
+            }
+            arr[j] = key;
+            moves += i - j;
+            comparisons += i - j + (j > 0);
+        }
+        instrument::add(instrument::Counter::moves, moves);
+        instrument::add(instrument::Counter::comparisons, comparisons);
         return arr;
     }
 
     template<typename T = int32_t>
     Array<T>& insertion_sort (Array<T>& arr) {
+        insertion_sort(arr.view());
+        return arr;
+    }
+    
+    // Block size the iterative merge sorts start merging from, picked with the ksweep benchmark suite
+    inline constexpr size_t default_base_case = 64;
+
+    // Sorts the K-sized chunks [first, last) of arr, sorting networks take every full chunk when there's one for K
+    template<typename T = int32_t, size_t K = default_base_case>
+    void sort_base_chunks (const ArrayView<T> arr, size_t first, const size_t last) {
+        if constexpr (network::supported<T, K>) {
+            const size_t full = last < arr.size / K ? last : arr.size / K;
+            if (first < full) {
+                network::sort_blocks<T, K>(arr.data + first * K, full - first);
+                instrument::add(instrument::Counter::comparisons,
+                                network::comparator_count<K>() * (full - first));
+            }
+            first = first > full ? first : full;
+        }
+        for (size_t c = first; c < last; c++) {
+            insertion_sort(arr[{c * K, (c + 1) * K}]);
+        }
+    }
+
+    // scratch has to hold at least arr.size elements, a smaller one is replaced by a temporary
+    template<typename T = int32_t, size_t K = default_base_case>
+    ArrayView<T> merge_sort_iterative (const ArrayView<T> arr, const ArrayView<std::type_identity_t<T>> scratch) {
         if (arr.size <= 1) {
             return arr;
+        } else if (arr.size <= K) {
+            return insertion_sort(arr);
+        }
+        if (scratch.size < arr.size) {
+            ScratchScope scope;
+            Array<T> buffer = scratch_array<T>(arr.size);
+            return merge_sort_iterative<T, K>(arr, buffer);
         }
 
-        Array<T> search_space = Array<T>::from(arr.data, arr.size); 
-        for (size_t i = 1; i < arr.size; i++) {
-            T key = arr[i];
+        sort_base_chunks<T, K>(arr, 0, (arr.size + K - 1) / K);
 
-            search_space = arr[{0, i}];
-            const size_t dest = binary_search(search_space, key);
-            for (size_t j = i; j > dest; j--) {
-                arr[j] = arr[j - 1];
-                arr[j - 1] = key;
+        // Every pass merges from one buffer into the other
+        ArrayView<T> src = arr;
+        ArrayView<T> dst = scratch[{0, arr.size}];
+        for (size_t width = K; width < arr.size; width *= 2) {
+            for (size_t i = 0; i < arr.size; i += width * 2) {
+                const ArrayView<T> run = src[{i, i + width * 2}];
+                merge<T>(run[{0, width}], run[{width, width * 2}], dst[{i, i + run.size}]);
             }
+            std::swap(src, dst);
+        }
+
+        // An odd number of passes leaves the result in scratch
+        if (src.data != arr.data) {
+            std::memcpy(arr.data, src.data, sizeof(T) * arr.size);
+            instrument::add(instrument::Counter::bytes_copied, sizeof(T) * arr.size);
         }
         return arr;
     }
-    
-    template<typename T = int32_t, size_t K = 2>
+
+    template<typename T = int32_t, size_t K = default_base_case>
     Array<T>& merge_sort_iterative (Array<T>& arr) {
-        size_t chunk_size = K;
-        
+        ScratchScope scope;
+        Array<T> scratch = scratch_array<T>(arr.size > K ? arr.size : 0);
+        merge_sort_iterative<T, K>(arr, scratch);
+        return arr;
+    }
+
+    // Consecutive wins of one run after which a merge stops comparing element by element and gallops
+    inline constexpr size_t gallop_threshold = 7;
+
+    // Runs at most this many times longer than the one they're merged with go through salad::merge
+    inline constexpr size_t balanced_run_ratio = 8;
+
+    // Stable merge of the adjacent sorted runs arr[lo, mid) and arr[mid, hi), after trimming the ends of both
+    // that are already in place. Runs of similar length are merged into scratch (which then has to hold both)
+    // and copied back. Otherwise one run dominates: only the shorter one is copied to scratch, and whenever a
+    // run keeps winning its whole block up to the other run's head is found by galloping and moved at once
+    template<typename T = int32_t>
+    void merge_runs (const ArrayView<T> arr, size_t lo, const size_t mid, size_t hi, const ArrayView<T> scratch) {
+        // Left elements not greater than the right run's first one, and right elements not less than the left
+        // run's last one, stay where they are. A presorted pair of runs ends here
+        lo += gallop_front<true>(arr.data + lo, mid - lo, arr[mid]);
+        if (lo == mid) {
+            return;
+        }
+        hi = mid + gallop_back<false>(arr.data + mid, hi - mid, arr[mid - 1]);
+
+        // Runs of similar length interleave finely, there the vectorized merge into scratch and a copy back
+        // beats merging in place
+        const size_t shorter = mid - lo < hi - mid ? mid - lo : hi - mid;
+        const size_t longer = mid - lo < hi - mid ? hi - mid : mid - lo;
+        if (shorter * balanced_run_ratio >= longer && scratch.size >= hi - lo) {
+            merge<T>(arr[{lo, mid}], arr[{mid, hi}], scratch[{0, hi - lo}]);
+            std::memcpy(arr.data + lo, scratch.data, sizeof(T) * (hi - lo));
+            instrument::add(instrument::Counter::moves, hi - lo);
+            return;
+        }
+
+        size_t comparisons = 0;
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+        if (mid - lo <= hi - mid) {
+            // Left run in scratch, merged front to back
+            T* a = scratch.data;
+            T* a_end = a + (mid - lo);
+            std::memcpy(a, arr.data + lo, sizeof(T) * (mid - lo));
+            const T* b = arr.data + mid;
+            const T* b_end = arr.data + hi;
+            T* out = arr.data + lo;
+
+            while (a != a_end && b != b_end) {
+                if (a_wins >= gallop_threshold) {
+                    const size_t n = gallop_front<true>(a, a_end - a, *b);
+                    std::memcpy(out, a, sizeof(T) * n);
+                    out += n;
+                    a += n;
+                    a_wins = 0;
+                } else if (b_wins >= gallop_threshold) {
+                    const size_t n = gallop_front<false>(b, b_end - b, *a);
+                    std::memmove(out, b, sizeof(T) * n);
+                    out += n;
+                    b += n;
+                    b_wins = 0;
+                } else {
+                    // Branchless, on random runs the winner is a coin flip
+                    const bool take_b = *b < *a;
+                    *out++ = take_b ? *b : *a;
+                    a += !take_b;
+                    b += take_b;
+                    // Arithmetic rather than ?:, which compiles to a branch here
+                    a_wins = (a_wins + 1) * !take_b;
+                    b_wins = (b_wins + 1) * take_b;
+                }
+                comparisons++;
+            }
+            // What's left of the right run is already in place
+            std::memcpy(out, a, sizeof(T) * (a_end - a));
+        } else {
+            // Right run in scratch, merged back to front
+            T* b = scratch.data;
+            T* b_end = b + (hi - mid);
+            std::memcpy(b, arr.data + mid, sizeof(T) * (hi - mid));
+            const T* a_begin = arr.data + lo;
+            const T* a_end = arr.data + mid;
+            T* out = arr.data + hi;
+
+            while (a_end != a_begin && b_end != b) {
+                if (a_wins >= gallop_threshold) {
+                    const size_t keep = gallop_back<true>(a_begin, a_end - a_begin, b_end[-1]);
+                    const size_t n = (a_end - a_begin) - keep;
+                    out -= n;
+                    a_end -= n;
+                    std::memmove(out, a_end, sizeof(T) * n);
+                    a_wins = 0;
+                } else if (b_wins >= gallop_threshold) {
+                    const size_t keep = gallop_back<false>(b, b_end - b, a_end[-1]);
+                    const size_t n = (b_end - b) - keep;
+                    out -= n;
+                    b_end -= n;
+                    std::memcpy(out, b_end, sizeof(T) * n);
+                    b_wins = 0;
+                } else {
+                    const bool take_a = b_end[-1] < a_end[-1];
+                    *--out = take_a ? a_end[-1] : b_end[-1];
+                    a_end -= take_a;
+                    b_end -= !take_a;
+                    a_wins = (a_wins + 1) * take_a;
+                    b_wins = (b_wins + 1) * !take_a;
+                }
+                comparisons++;
+            }
+            // What's left of the left run is already in place
+            std::memcpy(out - (b_end - b), b, sizeof(T) * (b_end - b));
+        }
+
+        instrument::add(instrument::Counter::comparisons, comparisons);
+        instrument::add(instrument::Counter::moves, hi - lo);
+    }
+
+    // Blocks natural_merge_sort sorts with networks at once when it runs into an unsorted stretch
+    inline constexpr size_t natural_network_group = 16;
+
+    // Shortest run natural_merge_sort merges, shorter ones are extended with insertion sort. Picked in [32, 64]
+    // so that n / min_run is a power of two or just below one, which keeps the final merges balanced
+    inline size_t natural_min_run (size_t n) {
+        size_t low_bits = 0;
+        while (n >= 64) {
+            low_bits |= n & 1;
+            n >>= 1;
+        }
+        return n + low_bits;
+    }
+
+    // Adaptive merge sort over the runs already in arr: ascending runs are kept, strictly descending ones
+    // reversed (strictly, so that it stays stable). Runs are merged off a stack whose lengths are kept
+    // growing faster than the Fibonacci numbers, which keeps the merges balanced, so presorted input costs a
+    // single scan and inputs made of few runs cost O(n log runs).
+    // scratch should hold arr.size elements, it's only allocated once a merge actually needs it otherwise
+    template<typename T = int32_t>
+    ArrayView<T> natural_merge_sort (const ArrayView<T> arr, const ArrayView<std::type_identity_t<T>> scratch) {
         if (arr.size <= 1) {
             return arr;
-        } else if (arr.size <= chunk_size) {
-            arr = insertion_sort(arr);
+        }
+
+        struct Run {
+            size_t start;
+            size_t size;
+        };
+        // Run sizes grow at least like the Fibonacci numbers, 85 is enough for any 64-bit size
+        Run runs[85];
+        size_t run_count = 0;
+
+        // The scope outlives buffer, whose arena block is only handed back once the sort is done
+        ScratchScope scope;
+        Array<T> buffer = Array<T>(nullptr, 0, false);
+        ArrayView<T> space = scratch;
+        auto merge_at = [&](const size_t i) {
+            const Run left = runs[i];
+            const Run right = runs[i + 1];
+            const size_t shorter = left.size < right.size ? left.size : right.size;
+            if (space.size < shorter) {
+                buffer = scratch_array<T>(arr.size);
+                space = buffer.view();
+            }
+            merge_runs(arr, left.start, right.start, right.start + right.size, space);
+
+            runs[i].size += right.size;
+            for (size_t r = i + 1; r + 1 < run_count; r++) {
+                runs[r] = runs[r + 1];
+            }
+            run_count--;
+        };
+
+        // Restores the invariants on the top four runs: each is longer than the two above it together,
+        // and each is longer than the one above it
+        auto push_run = [&](const Run run) {
+            runs[run_count++] = run;
+            while (run_count > 1) {
+                size_t n = run_count - 2;
+                if ((n > 0 && runs[n - 1].size <= runs[n].size + runs[n + 1].size) ||
+                    (n > 1 && runs[n - 2].size <= runs[n - 1].size + runs[n].size)) {
+                    if (runs[n - 1].size < runs[n + 1].size) {
+                        n--;
+                    }
+                } else if (runs[n].size > runs[n + 1].size) {
+                    break;
+                }
+                merge_at(n);
+            }
+        };
+
+        const size_t min_run = natural_min_run(arr.size);
+        size_t comparisons = 0;
+        for (size_t start = 0; start < arr.size; ) {
+            size_t end = start + 1;
+            if (end < arr.size) {
+                comparisons++;
+                if (arr[end] < arr[start]) {
+                    while (end + 1 < arr.size && arr[end + 1] < arr[end]) {
+                        end++;
+                    }
+                    end++;
+                    std::reverse(arr.data + start, arr.data + end);
+                } else {
+                    while (end + 1 < arr.size && !(arr[end + 1] < arr[end])) {
+                        end++;
+                    }
+                    end++;
+                }
+                comparisons += end - start - 1;
+            }
+
+            // A short run means this part of the input isn't presorted. For arithmetic types a group of blocks is
+            // sorted with the networks at once (vectorized across blocks, their instability can't be observed on
+            // equal numbers), anything else extends the run with insertion sort, which doesn't move its sorted part
+            if (end - start < min_run && end < arr.size) {
+                if constexpr (network::supported<T, default_base_case>) {
+                    constexpr size_t block = default_base_case;
+                    const size_t blocks = std::min(natural_network_group, (arr.size - start) / block);
+                    if (blocks > 0) {
+                        network::sort_blocks<T, block>(arr.data + start, blocks);
+                        instrument::add(instrument::Counter::comparisons, network::comparator_count<block>() * blocks);
+                        for (size_t b = 0; b < blocks; b++) {
+                            push_run(Run{start + b * block, block});
+                        }
+                        start += blocks * block;
+                        continue;
+                    }
+                }
+                const size_t extended = start + min_run < arr.size ? start + min_run : arr.size;
+                insertion_sort(arr[{start, extended}], end - start);
+                end = extended;
+            }
+
+            push_run(Run{start, end - start});
+            start = end;
+        }
+
+        while (run_count > 1) {
+            size_t n = run_count - 2;
+            if (n > 0 && runs[n - 1].size < runs[n + 1].size) {
+                n--;
+            }
+            merge_at(n);
+        }
+
+        instrument::add(instrument::Counter::comparisons, comparisons);
+        return arr;
+    }
+
+    template<typename T = int32_t>
+    Array<T>& natural_merge_sort (Array<T>& arr) {
+        natural_merge_sort<T>(arr.view(), ArrayView<T>{nullptr, 0});
+        return arr;
+    }
+
+    // Number of elements of a that come first in the first k elements of merge(a, b)
+    template<typename T = int32_t>
+    size_t co_rank (const ArrayView<T> a, const ArrayView<T> b, const size_t k) {
+        size_t lo = k > b.size ? k - b.size : 0;
+        size_t hi = k < a.size ? k : a.size;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo + 1) / 2;
+            if (a[mid - 1] <= b[k - mid]) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        return lo;
+    }
+
+    // scratch has to hold at least arr.size elements, a smaller one is replaced by a temporary
+    template<typename T = int32_t, size_t K = default_base_case>
+    ArrayView<T> parallel_merge_sort_iterative (const ArrayView<T> arr, const ArrayView<std::type_identity_t<T>> scratch,
+                                                ThreadPool& pool) {
+        const size_t threads = pool.size() > 0 ? pool.size() : 1;
+        if (arr.size <= K || threads == 1) {
+            return merge_sort_iterative<T, K>(arr, scratch);
+        }
+        if (scratch.size < arr.size) {
+            ScratchScope scope;
+            Array<T> buffer = scratch_array<T>(arr.size);
+            return parallel_merge_sort_iterative<T, K>(arr, buffer, pool);
+        }
+
+        // Sort the base chunks, a few tasks per thread so stealing can balance them out
+        const size_t chunks = (arr.size + K - 1) / K;
+        const size_t chunks_per_task = (chunks + threads * 4 - 1) / (threads * 4);
+        pool.parallel_for(0, chunks, chunks_per_task, [arr](const size_t first, const size_t last) {
+            sort_base_chunks<T, K>(arr, first, last);
+        });
+
+        // Passes alternate between the array and scratch
+        ArrayView<T> src = arr;
+        ArrayView<T> dst = scratch[{0, arr.size}];
+        for (size_t width = K; width < arr.size; width *= 2) {
+            const size_t pairs = (arr.size + width * 2 - 1) / (width * 2);
+            // Once there are too few pairs to keep every thread busy, each merge is split up at co-ranked
+            // points (merge path), so the last passes run on all threads as well
+            const size_t parts = pairs >= threads ? 1 : (threads * 2 + pairs - 1) / pairs;
+
+            pool.parallel_for(0, pairs * parts, 1, [&](const size_t first, const size_t last) {
+                for (size_t task = first; task < last; task++) {
+                    const size_t pair = task / parts;
+                    const size_t part = task % parts;
+
+                    const ArrayView<T> run = src[{pair * width * 2, (pair + 1) * width * 2}];
+                    const ArrayView<T> left = run[{0, width}];
+                    const ArrayView<T> right = run[{width, width * 2}];
+
+                    const size_t out_first = run.size * part / parts;
+                    const size_t out_last = run.size * (part + 1) / parts;
+                    const size_t left_first = co_rank(left, right, out_first);
+                    const size_t left_last = co_rank(left, right, out_last);
+
+                    const ArrayView<T> out = dst[{pair * width * 2, (pair + 1) * width * 2}];
+                    merge<T>(left[{left_first, left_last}],
+                             right[{out_first - left_first, out_last - left_last}],
+                             out[{out_first, out_last}]);
+                }
+            });
+            std::swap(src, dst);
+        }
+
+        if (src.data != arr.data) {
+            const size_t block = (arr.size + threads - 1) / threads;
+            pool.parallel_for(0, arr.size, block, [&](const size_t first, const size_t last) {
+                std::memcpy(arr.data + first, src.data + first, sizeof(T) * (last - first));
+            });
+            instrument::add(instrument::Counter::bytes_copied, sizeof(T) * arr.size);
+        }
+        return arr;
+    }
+
+    template<typename T = int32_t, size_t K = default_base_case>
+    ArrayView<T> parallel_merge_sort_iterative (const ArrayView<T> arr, ThreadPool& pool) {
+        ScratchScope scope;
+        Array<T> scratch = scratch_array<T>(arr.size > K ? arr.size : 0);
+        return parallel_merge_sort_iterative<T, K>(arr, scratch, pool);
+    }
+
+    template<typename T = int32_t, size_t K = default_base_case>
+    Array<T>& parallel_merge_sort_iterative (Array<T>& arr) {
+        parallel_merge_sort_iterative<T, K>(arr.view(), ThreadPool::global());
+        return arr;
+    }
+
+    template<typename T = int32_t>
+    ArrayView<T> radix_sort (const ArrayView<T> arr) {
+        static_assert(std::is_integral_v<T>, "radix_sort only sorts integers");
+        using key_t = std::make_unsigned_t<T>;
+        constexpr size_t digit_bits = 8;
+        constexpr size_t radix = 1 << digit_bits;
+        constexpr size_t digits = sizeof(T) * 8 / digit_bits;
+        // Flipping the sign bit puts negative values before positive ones in unsigned order
+        constexpr key_t sign_flip = std::is_signed_v<T> ? key_t(1) << (sizeof(T) * 8 - 1) : 0;
+
+        if (arr.size <= 1) {
             return arr;
         }
 
-        Array<T> arr_view = Array<T>::from(arr.data, arr.size);
-        for (size_t i = 0; i < arr.size; i += chunk_size) {
-            arr_view = arr[{i, i + chunk_size}];
-            insertion_sort(arr_view);
+        // Histogram every digit in a single pass over the input
+        size_t counts[digits][radix] = {};
+        for (size_t i = 0; i < arr.size; i++) {
+            const key_t key = static_cast<key_t>(arr[i]) ^ sign_flip;
+            for (size_t d = 0; d < digits; d++) {
+                counts[d][(key >> (d * digit_bits)) & (radix - 1)]++;
+            }
         }
 
-        size_t sublists = std::ceil(static_cast<double>(arr.size) / static_cast<double>(chunk_size));
+        ScratchScope scope;
+        Array<T> buffer = scratch_array<T>(arr.size);
+        T* src = arr.data;
+        T* dst = buffer.data;
+        for (size_t d = 0; d < digits; d++) {
+            const size_t shift = d * digit_bits;
+            size_t* count = counts[d];
 
-        while (sublists > 1) {
-            for (size_t i = 0; i < arr.size; i += chunk_size * 2) {
-                arr_view = arr[{i, i + chunk_size * 2}];
-                Array<T> left = arr_view[{0, chunk_size}];
-                Array<T> right = arr_view[{chunk_size, chunk_size * 2}];
-                
-                Array<T> out_buffer = Array<T>(arr_view.size);
-                merge<T>(left, right, out_buffer);
-                std::memcpy(arr.data + i, out_buffer.data, sizeof(T) * arr_view.size);
-                salad::copies += sizeof(T) * arr_view.size;
+            // All keys share this digit, the pass wouldn't move anything
+            if (count[((static_cast<key_t>(src[0]) ^ sign_flip) >> shift) & (radix - 1)] == arr.size) {
+                continue;
             }
-            sublists = std::ceil(static_cast<double>(sublists) / 2.0f);
-            chunk_size *= 2;
+
+            size_t offset = 0;
+            for (size_t b = 0; b < radix; b++) {
+                const size_t n = count[b];
+                count[b] = offset;
+                offset += n;
+            }
+
+            for (size_t i = 0; i < arr.size; i++) {
+                const key_t key = static_cast<key_t>(src[i]) ^ sign_flip;
+                dst[count[(key >> shift) & (radix - 1)]++] = src[i];
+            }
+            instrument::add(instrument::Counter::moves, arr.size);
+            std::swap(src, dst);
         }
 
+        // An odd number of passes leaves the result in the buffer
+        if (src != arr.data) {
+            std::memcpy(arr.data, src, sizeof(T) * arr.size);
+            instrument::add(instrument::Counter::bytes_copied, sizeof(T) * arr.size);
+        }
+        return arr;
+    }
+
+    template<typename T = int32_t>
+    Array<T>& radix_sort (Array<T>& arr) {
+        radix_sort(arr.view());
         return arr;
     }
 }
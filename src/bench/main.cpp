@@ -0,0 +1,547 @@
+#include "main.h"
+
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <fmt/format.h>
+
+#include "1/main.h"
+#include "1/autotune.h"
+#include "arr_util.h"
+#include "color_tools.h"
+#include "instrument.h"
+#include "int_conv.h"
+#include "reduce.h"
+#include "search_index.h"
+
+using salad::Array;
+using namespace salad::bench;
+namespace instrument = salad::instrument;
+
+namespace {
+    struct Options {
+        size_t min_n = 100;
+        size_t max_n = 100'000'000;
+        double min_time = 0.2;  // Seconds spent per measurement (at least one run)
+        Reporter::Format format = Reporter::Format::csv;
+        std::vector<std::string> algos;  // Empty means all of them
+        std::vector<std::string> dists;
+        std::vector<std::string> suites = {"sort"};
+    };
+
+    struct SortEngine {
+        std::string_view name;
+        Array<uint32_t>& (*sort)(Array<uint32_t>&);
+        // Quadratic sorts are skipped above this size
+        size_t max_n;
+    };
+
+    Array<uint32_t>& std_sort(Array<uint32_t>& arr) {
+        std::sort(arr.begin(), arr.end());
+        return arr;
+    }
+
+    Array<uint32_t>& std_stable_sort(Array<uint32_t>& arr) {
+        std::stable_sort(arr.begin(), arr.end());
+        return arr;
+    }
+
+    constexpr size_t unlimited = ~size_t{0};
+
+    const SortEngine sort_engines[] = {
+        {"merge_sort", salad::merge_sort<uint32_t>, unlimited},
+        {"insertion_sort", salad::insertion_sort<uint32_t>, 100'000},
+        {"imerge_sort<2>", salad::merge_sort_iterative<uint32_t, 2>, unlimited},
+        {"imerge_sort<32>", salad::merge_sort_iterative<uint32_t, 32>, unlimited},
+        {"pmerge_sort<32>", salad::parallel_merge_sort_iterative<uint32_t, 32>, unlimited},
+        {"nmerge_sort", salad::natural_merge_sort<uint32_t>, unlimited},
+        {"radix_sort", salad::radix_sort<uint32_t>, unlimited},
+        {"auto", salad::autotune::sort<uint32_t>, unlimited},
+        {"std::sort", std_sort, unlimited},
+        {"std::stable_sort", std_stable_sort, unlimited},
+    };
+
+    std::vector<std::string> split(const std::string_view list) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (start <= list.size()) {
+            const size_t comma = std::min(list.find(',', start), list.size());
+            if (comma > start) {
+                parts.emplace_back(list.substr(start, comma - start));
+            }
+            start = comma + 1;
+        }
+        return parts;
+    }
+
+    uint64_t counter(const instrument::Snapshot& counters, instrument::Counter c) {
+        return counters[static_cast<size_t>(c)];
+    }
+
+    bool selected(const std::vector<std::string>& filter, const std::string_view name) {
+        return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+    }
+
+    // Times engine on copies of input until min_time has passed and reports the averages
+    void measure_sort(const Options& options, Reporter& reporter, const std::string_view suite,
+                      const SortEngine& engine, const size_t dist, const Array<uint32_t>& input, Array<uint32_t>& work) {
+        const size_t n = input.size;
+        size_t reps = 0;
+        double elapsed = 0;
+        // Counters of the last run
+        instrument::Snapshot counters{};
+        do {
+            std::memcpy(work.data, input.data, sizeof(uint32_t) * n);
+            const instrument::Snapshot before = instrument::snapshot();
+
+            const auto start = std::chrono::steady_clock::now();
+            engine.sort(work);
+            elapsed += seconds_since(start);
+
+            counters = instrument::difference(instrument::snapshot(), before);
+            reps++;
+        } while (elapsed < options.min_time);
+
+        const double per_run = elapsed / static_cast<double>(reps);
+        reporter.row({
+            Reporter::text("suite", suite),
+            Reporter::text("algo", engine.name),
+            Reporter::text("dist", distribution_names[dist]),
+            Reporter::number("n", n),
+            Reporter::number("reps", reps),
+            Reporter::number("ns_per_elem", fmt::format("{:.3f}", per_run * 1e9 / static_cast<double>(n))),
+            Reporter::number("melem_per_s", fmt::format("{:.2f}", static_cast<double>(n) / per_run / 1e6)),
+            Reporter::number("mb_per_s", fmt::format("{:.2f}", static_cast<double>(n * sizeof(uint32_t)) / per_run / 1e6)),
+            Reporter::number("bytes_copied", counter(counters, instrument::Counter::bytes_copied)),
+            Reporter::number("allocations", counter(counters, instrument::Counter::allocations)),
+            Reporter::number("comparisons", counter(counters, instrument::Counter::comparisons)),
+            Reporter::number("moves", counter(counters, instrument::Counter::moves)),
+            Reporter::number("sorted", std::is_sorted(work.begin(), work.end())),
+        });
+    }
+
+    void sort_suite(const Options& options, Reporter& reporter) {
+        for (size_t d = 0; d < std::size(distribution_names); d++) {
+            if (!selected(options.dists, distribution_names[d])) {
+                continue;
+            }
+
+            for (size_t n = options.min_n; n <= options.max_n; n *= 10) {
+                const Array<uint32_t> input = generate<uint32_t>(static_cast<Distribution>(d), n);
+                Array<uint32_t> work = Array<uint32_t>(n, salad::uninitialized);
+
+                for (const SortEngine& engine : sort_engines) {
+                    if (!selected(options.algos, engine.name) || n > engine.max_n) {
+                        continue;
+                    }
+                    measure_sort(options, reporter, "sort", engine, d, input, work);
+                }
+            }
+        }
+    }
+
+    // Every base case size of the iterative merge sort, to pick salad::default_base_case from.
+    // 2 and 4 use insertion sort, the rest sorting networks
+    const SortEngine base_case_engines[] = {
+        {"imerge_sort<2>", salad::merge_sort_iterative<uint32_t, 2>, unlimited},
+        {"imerge_sort<4>", salad::merge_sort_iterative<uint32_t, 4>, unlimited},
+        {"imerge_sort<8>", salad::merge_sort_iterative<uint32_t, 8>, unlimited},
+        {"imerge_sort<16>", salad::merge_sort_iterative<uint32_t, 16>, unlimited},
+        {"imerge_sort<32>", salad::merge_sort_iterative<uint32_t, 32>, unlimited},
+        {"imerge_sort<64>", salad::merge_sort_iterative<uint32_t, 64>, unlimited},
+    };
+
+    void ksweep_suite(const Options& options, Reporter& reporter) {
+        for (size_t d = 0; d < std::size(distribution_names); d++) {
+            if (!selected(options.dists, distribution_names[d])) {
+                continue;
+            }
+
+            for (size_t n = options.min_n; n <= options.max_n; n *= 10) {
+                const Array<uint32_t> input = generate<uint32_t>(static_cast<Distribution>(d), n);
+                Array<uint32_t> work = Array<uint32_t>(n, salad::uninitialized);
+
+                for (const SortEngine& engine : base_case_engines) {
+                    if (!selected(options.algos, engine.name)) {
+                        continue;
+                    }
+                    measure_sort(options, reporter, "ksweep", engine, d, input, work);
+                }
+            }
+        }
+    }
+
+    struct SearchEngine {
+        std::string_view name;
+        // Answers every query into out, index is only set for the engines that need it
+        void (*search)(const salad::ArrayView<uint32_t> sorted, const salad::EytzingerIndex<uint32_t>& index,
+                       const salad::ArrayView<uint32_t> queries, const salad::ArrayView<size_t> out);
+    };
+
+    const SearchEngine search_engines[] = {
+        {"binary_search", [](const auto sorted, const auto&, const auto queries, const auto out) {
+            for (size_t q = 0; q < queries.size; q++) {
+                out[q] = salad::binary_search<uint32_t, size_t>(sorted, queries[q]);
+            }
+        }},
+        {"branchless", [](const auto sorted, const auto&, const auto queries, const auto out) {
+            for (size_t q = 0; q < queries.size; q++) {
+                out[q] = salad::branchless_lower_bound(sorted, queries[q]);
+            }
+        }},
+        {"branchless_batch", [](const auto sorted, const auto&, const auto queries, const auto out) {
+            salad::branchless_lower_bound_batch(sorted, queries, out);
+        }},
+        {"eytzinger", [](const auto, const auto& index, const auto queries, const auto out) {
+            for (size_t q = 0; q < queries.size; q++) {
+                out[q] = index.lower_bound(queries[q]);
+            }
+        }},
+        {"eytzinger_batch", [](const auto, const auto& index, const auto queries, const auto out) {
+            index.lower_bound_batch(queries, out);
+        }},
+    };
+
+    // Random lookups into sorted arrays from L1 sized up to DRAM sized
+    void search_suite(const Options& options, Reporter& reporter) {
+        constexpr size_t query_count = 1 << 20;
+        const Array<uint32_t> queries = generate<uint32_t>(Distribution::random, query_count, 0xfeed);
+        Array<size_t> expected = Array<size_t>(query_count, salad::uninitialized);
+        Array<size_t> out = Array<size_t>(query_count, salad::uninitialized);
+
+        for (size_t n = options.min_n; n <= options.max_n; n *= 10) {
+            const Array<uint32_t> sorted = generate<uint32_t>(Distribution::sorted, n);
+            const salad::EytzingerIndex<uint32_t> index(sorted);
+            for (size_t q = 0; q < query_count; q++) {
+                expected[q] = std::lower_bound(sorted.begin(), sorted.end(), queries[q]) - sorted.begin();
+            }
+
+            for (const SearchEngine& engine : search_engines) {
+                if (!selected(options.algos, engine.name)) {
+                    continue;
+                }
+
+                size_t reps = 0;
+                double elapsed = 0;
+                do {
+                    const auto start = std::chrono::steady_clock::now();
+                    engine.search(sorted, index, queries, out);
+                    elapsed += seconds_since(start);
+                    reps++;
+                } while (elapsed < options.min_time);
+
+                const double per_query = elapsed / static_cast<double>(reps * query_count);
+                reporter.row({
+                    Reporter::text("suite", "search"),
+                    Reporter::text("algo", engine.name),
+                    Reporter::number("n", n),
+                    Reporter::number("bytes", n * sizeof(uint32_t)),
+                    Reporter::number("queries", query_count),
+                    Reporter::number("reps", reps),
+                    Reporter::number("ns_per_query", fmt::format("{:.3f}", per_query * 1e9)),
+                    Reporter::number("mqueries_per_s", fmt::format("{:.2f}", 1e-6 / per_query)),
+                    Reporter::number("correct", std::equal(out.begin(), out.end(), expected.begin())),
+                });
+            }
+        }
+    }
+
+    // Tokens of the conversion suite, one per line like the notes
+    struct Tokens {
+        std::string text;
+        Array<size_t> starts;   // Token i is text[starts[i]:starts[i + 1] - 1], the last entry is text.size()
+        Array<int64_t> values;
+    };
+
+    Tokens make_tokens(const std::string_view width, const size_t count) {
+        std::mt19937_64 rng(0xc0de);
+        Tokens tokens{{}, Array<size_t>(count + 1, salad::uninitialized), Array<int64_t>(count, salad::uninitialized)};
+        char buffer[32];
+        for (size_t i = 0; i < count; i++) {
+            const uint64_t bits = rng();
+            tokens.values[i] = width == "short" ? static_cast<int64_t>(bits % 1000)
+                             : width == "uint32" ? static_cast<int64_t>(static_cast<uint32_t>(bits))
+                             : static_cast<int64_t>(bits);
+            tokens.starts[i] = tokens.text.size();
+            tokens.text.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), tokens.values[i]).ptr);
+            tokens.text.push_back('\n');
+        }
+        tokens.starts[count] = tokens.text.size();
+        return tokens;
+    }
+
+    struct ConvEngine {
+        std::string_view name;
+        // Parses every token into out, or formats every value into out (one per line), returning the bytes written
+        size_t (*run)(const Tokens& tokens, Array<int64_t>& values, char* text);
+    };
+
+    const ConvEngine conv_engines[] = {
+        {"salad::parse_int", [](const Tokens& tokens, Array<int64_t>& values, char*) -> size_t {
+            for (size_t i = 0; i < values.size; i++) {
+                const std::string_view token(tokens.text.data() + tokens.starts[i], tokens.starts[i + 1] - tokens.starts[i] - 1);
+                salad::parse_int(token, values[i]);
+            }
+            return 0;
+        }},
+        {"std::from_chars", [](const Tokens& tokens, Array<int64_t>& values, char*) -> size_t {
+            for (size_t i = 0; i < values.size; i++) {
+                const char* token = tokens.text.data() + tokens.starts[i];
+                std::from_chars(token, tokens.text.data() + tokens.starts[i + 1] - 1, values[i]);
+            }
+            return 0;
+        }},
+        {"salad::format_int", [](const Tokens& tokens, Array<int64_t>&, char* text) -> size_t {
+            char* p = text;
+            for (size_t i = 0; i < tokens.values.size; i++) {
+                p = salad::format_int(p, p + salad::max_chars<int64_t>, tokens.values[i]).ptr;
+                *p++ = '\n';
+            }
+            return p - text;
+        }},
+        {"std::to_chars", [](const Tokens& tokens, Array<int64_t>&, char* text) -> size_t {
+            char* p = text;
+            for (size_t i = 0; i < tokens.values.size; i++) {
+                p = std::to_chars(p, p + salad::max_chars<int64_t>, tokens.values[i]).ptr;
+                *p++ = '\n';
+            }
+            return p - text;
+        }},
+    };
+
+    // Parsing and formatting one integer per line, as short as the sample notes or as long as an int64 gets
+    void conv_suite(const Options& options, Reporter& reporter) {
+        constexpr size_t token_count = 1 << 20;
+        for (const std::string_view width : {"short", "uint32", "int64"}) {
+            if (!selected(options.dists, width)) {
+                continue;
+            }
+            const Tokens tokens = make_tokens(width, token_count);
+            Array<int64_t> values = Array<int64_t>(token_count, salad::uninitialized);
+            Array<char> text = Array<char>(token_count * (salad::max_chars<int64_t> + 1), salad::uninitialized);
+
+            for (const ConvEngine& engine : conv_engines) {
+                if (!selected(options.algos, engine.name)) {
+                    continue;
+                }
+
+                size_t reps = 0;
+                size_t written = 0;
+                double elapsed = 0;
+                do {
+                    const auto start = std::chrono::steady_clock::now();
+                    written = engine.run(tokens, values, text.data);
+                    elapsed += seconds_since(start);
+                    reps++;
+                } while (elapsed < options.min_time);
+
+                // Parsers are checked against the values, formatters against the text
+                const bool correct = written == 0
+                    ? std::equal(values.begin(), values.end(), tokens.values.begin())
+                    : std::string_view(text.data, written) == tokens.text;
+                const double per_token = elapsed / static_cast<double>(reps * token_count);
+                reporter.row({
+                    Reporter::text("suite", "conv"),
+                    Reporter::text("algo", engine.name),
+                    Reporter::text("dist", width),
+                    Reporter::number("n", token_count),
+                    Reporter::number("reps", reps),
+                    Reporter::number("ns_per_token", fmt::format("{:.3f}", per_token * 1e9)),
+                    Reporter::number("mb_per_s", fmt::format("{:.2f}", static_cast<double>(tokens.text.size()) * reps / elapsed / 1e6)),
+                    Reporter::number("correct", correct),
+                });
+            }
+        }
+    }
+
+    struct ReduceEngine {
+        std::string_view name;
+        uint64_t (*sum)(salad::ArrayView<uint32_t> a, salad::ArrayView<uint32_t> b);
+    };
+
+    const ReduceEngine reduce_engines[] = {
+        {"scalar", [](const salad::ArrayView<uint32_t> a, const salad::ArrayView<uint32_t> b) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < a.size; i++) {
+                sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+            }
+            return sum;
+        }},
+        {"abs_diff_sum", [](const salad::ArrayView<uint32_t> a, const salad::ArrayView<uint32_t> b) {
+            return salad::abs_diff_sum(a, b);
+        }},
+        {"abs_diff_sum_parallel", [](const salad::ArrayView<uint32_t> a, const salad::ArrayView<uint32_t> b) {
+            return salad::abs_diff_sum(a, b, salad::ThreadPool::global());
+        }},
+    };
+
+    // The part 1 distance sum over two columns, reported as bandwidth since it should be memory bound
+    void reduce_suite(const Options& options, Reporter& reporter) {
+        for (size_t n = options.min_n; n <= options.max_n; n *= 10) {
+            const Array<uint32_t> a = generate<uint32_t>(Distribution::random, n);
+            const Array<uint32_t> b = generate<uint32_t>(Distribution::random, n, 0xb0b);
+            uint64_t expected = 0;
+            for (size_t i = 0; i < n; i++) {
+                expected += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+            }
+
+            for (const ReduceEngine& engine : reduce_engines) {
+                if (!selected(options.algos, engine.name)) {
+                    continue;
+                }
+
+                size_t reps = 0;
+                uint64_t sum = 0;
+                double elapsed = 0;
+                do {
+                    const auto start = std::chrono::steady_clock::now();
+                    sum = engine.sum(a, b);
+                    elapsed += seconds_since(start);
+                    reps++;
+                } while (elapsed < options.min_time);
+
+                const double per_run = elapsed / static_cast<double>(reps);
+                reporter.row({
+                    Reporter::text("suite", "reduce"),
+                    Reporter::text("algo", engine.name),
+                    Reporter::number("n", n),
+                    Reporter::number("reps", reps),
+                    Reporter::number("ns_per_elem", fmt::format("{:.3f}", per_run * 1e9 / static_cast<double>(n))),
+                    Reporter::number("gb_per_s", fmt::format("{:.2f}", static_cast<double>(2 * n * sizeof(uint32_t)) / per_run / 1e9)),
+                    Reporter::number("correct", sum == expected),
+                });
+            }
+        }
+    }
+
+    struct ColorEngine {
+        std::string_view name;
+        bool colored;
+        // Appends one status line per value of 0 to lines - 1 to out
+        void (*run)(fmt::memory_buffer& out, size_t lines);
+    };
+
+    const ColorEngine color_engines[] = {
+        {"fmt::format", false, [](fmt::memory_buffer& out, const size_t lines) {
+            for (size_t i = 0; i < lines; i++) {
+                fmt::format_to(std::back_inserter(out), "..:: Sorted Array [{}] ::..\n", i);
+            }
+        }},
+        {"format_color", true, [](fmt::memory_buffer& out, const size_t lines) {
+            for (size_t i = 0; i < lines; i++) {
+                const std::string size = salad::format_color("{" + salad::itos(i) + ":f cyan}");
+                fmt::format_to(std::back_inserter(out), "..:: Sorted Array [{}] ::..\n", size);
+            }
+        }},
+        {"color_format", true, [](fmt::memory_buffer& out, const size_t lines) {
+            for (size_t i = 0; i < lines; i++) {
+                salad::color_format<"..:: Sorted Array [{:f cyan}] ::..\n">.format_to(std::back_inserter(out), i);
+            }
+        }},
+    };
+
+    // A coloured status line, parsed on every call or compiled ahead of time, against the same line without colour
+    void color_suite(const Options& options, Reporter& reporter) {
+        constexpr size_t lines = 1 << 16;
+        fmt::memory_buffer expected_plain;
+        fmt::memory_buffer expected_colored;
+        color_engines[0].run(expected_plain, lines);
+        color_engines[1].run(expected_colored, lines);
+
+        fmt::memory_buffer out;
+        for (const ColorEngine& engine : color_engines) {
+            if (!selected(options.algos, engine.name)) {
+                continue;
+            }
+
+            size_t reps = 0;
+            double elapsed = 0;
+            do {
+                out.clear();
+                const auto start = std::chrono::steady_clock::now();
+                engine.run(out, lines);
+                elapsed += seconds_since(start);
+                reps++;
+            } while (elapsed < options.min_time);
+
+            const fmt::memory_buffer& expected = engine.colored ? expected_colored : expected_plain;
+            reporter.row({
+                Reporter::text("suite", "color"),
+                Reporter::text("algo", engine.name),
+                Reporter::number("n", lines),
+                Reporter::number("reps", reps),
+                Reporter::number("ns_per_line", fmt::format("{:.3f}", elapsed * 1e9 / static_cast<double>(reps * lines))),
+                Reporter::number("correct", std::string_view(out.data(), out.size()) ==
+                                            std::string_view(expected.data(), expected.size())),
+            });
+        }
+    }
+
+    void usage(const char* argv0) {
+        std::cerr << fmt::format(
+            "Usage: {} [options]\n"
+            "  --min-n N          Smallest input size (default 100)\n"
+            "  --max-n N          Largest input size, sizes grow by 10x (default 100000000)\n"
+            "  --min-time S       Seconds to repeat each measurement for (default 0.2)\n"
+            "  --format csv|json  Output CSV or JSON lines (default csv)\n"
+            "  --algos a,b,...    Only run these sorts\n"
+            "  --dists a,b,...    Only use these input distributions (token widths short, uint32, int64 for conv)\n"
+            "  --suites a,b,...   Benchmarks to run: sort, ksweep, search, conv, reduce, color (default sort)\n", argv0);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--min-n") {
+            options.min_n = std::stoull(value);
+        } else if (arg == "--max-n") {
+            options.max_n = std::stoull(value);
+        } else if (arg == "--min-time") {
+            options.min_time = std::stod(value);
+        } else if (arg == "--format") {
+            options.format = std::string_view(value) == "json" ? Reporter::Format::json : Reporter::Format::csv;
+        } else if (arg == "--algos") {
+            options.algos = split(value);
+        } else if (arg == "--dists") {
+            options.dists = split(value);
+        } else if (arg == "--suites") {
+            options.suites = split(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.min_n == 0) {
+        options.min_n = 1;
+    }
+
+    Reporter reporter(options.format);
+    if (selected(options.suites, "sort")) {
+        sort_suite(options, reporter);
+    }
+    if (selected(options.suites, "ksweep")) {
+        ksweep_suite(options, reporter);
+    }
+    if (selected(options.suites, "search")) {
+        search_suite(options, reporter);
+    }
+    if (selected(options.suites, "conv")) {
+        conv_suite(options, reporter);
+    }
+    if (selected(options.suites, "reduce")) {
+        reduce_suite(options, reporter);
+    }
+    if (selected(options.suites, "color")) {
+        color_suite(options, reporter);
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+//
+// Author: Salladen
+// Date: 17/10/2026
+// Project: Algos
+//
+
+#ifndef BENCH_MAIN_H
+#define BENCH_MAIN_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include "arr_util.h"
+
+namespace salad::bench {
+    enum class Distribution { random, sorted, reversed, few_unique, organ_pipe, zipf, sorted_tail };
+
+    inline constexpr std::string_view distribution_names[] = {
+        "random", "sorted", "reversed", "few_unique", "organ_pipe", "zipf", "sorted_tail"
+    };
+
+    template<typename T = uint32_t>
+    Array<T> generate(const Distribution dist, const size_t n, const uint64_t seed = 0x5a1ad) {
+        Array<T> out = Array<T>(n, uninitialized);
+        std::mt19937_64 rng(seed);
+
+        switch (dist) {
+        case Distribution::random:
+            for (T& x : out) {
+                x = static_cast<T>(rng());
+            }
+            break;
+        case Distribution::sorted:
+        case Distribution::reversed:
+            for (T& x : out) {
+                x = static_cast<T>(rng());
+            }
+            std::sort(out.begin(), out.end());
+            if (dist == Distribution::reversed) {
+                std::reverse(out.begin(), out.end());
+            }
+            break;
+        case Distribution::few_unique:
+            for (T& x : out) {
+                x = static_cast<T>(rng() % 16) * 1000003;
+            }
+            break;
+        case Distribution::organ_pipe:
+            // Ascending first half, descending second half
+            for (size_t i = 0; i < n; i++) {
+                out[i] = static_cast<T>(i < n / 2 ? i : n - i);
+            }
+            break;
+        case Distribution::zipf: {
+            // Ranks drawn with P(k) ~ 1/k^1.1 over a universe of up to 2^20 values
+            const size_t universe = std::clamp<size_t>(n, 1, 1 << 20);
+            std::vector<double> cdf(universe);
+            double total = 0;
+            for (size_t k = 0; k < universe; k++) {
+                total += 1.0 / std::pow(static_cast<double>(k + 1), 1.1);
+                cdf[k] = total;
+            }
+            std::uniform_real_distribution<double> uniform(0, total);
+            for (T& x : out) {
+                const auto rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+                // Scatter the ranks so that frequent values aren't also the smallest ones
+                x = static_cast<T>(static_cast<uint64_t>(rank) * 0x9E3779B1u);
+            }
+            break;
+        }
+        case Distribution::sorted_tail:
+            // Sorted with 5% random values appended, like a log that's been added to since it was last sorted
+            for (T& x : out) {
+                x = static_cast<T>(rng());
+            }
+            std::sort(out.begin(), out.begin() + (n - n / 20));
+            break;
+        }
+        return out;
+    }
+
+    // Writes result rows as CSV (header whenever the columns change) or JSON lines
+    class Reporter {
+    public:
+        enum class Format { csv, json };
+
+        struct Field {
+            std::string_view name;
+            std::string value;
+            bool quoted;
+        };
+
+        explicit Reporter(const Format format, std::ostream& out = std::cout) : format(format), out(out) {}
+
+        static Field text(const std::string_view name, const std::string_view value) {
+            return {name, std::string(value), true};
+        }
+
+        template<typename V>
+        static Field number(const std::string_view name, const V value) {
+            return {name, fmt::format("{}", value), false};
+        }
+
+        void row(const std::vector<Field>& fields) {
+            if (format == Format::json) {
+                std::string line = "{";
+                for (size_t i = 0; i < fields.size(); i++) {
+                    line += fields[i].quoted ? fmt::format("\"{}\": \"{}\"", fields[i].name, fields[i].value)
+                                             : fmt::format("\"{}\": {}", fields[i].name, fields[i].value);
+                    line += i + 1 < fields.size() ? ", " : "}\n";
+                }
+                out << line << std::flush;
+                return;
+            }
+
+            std::vector<std::string_view> names;
+            for (const Field& field : fields) {
+                names.push_back(field.name);
+            }
+            if (names != columns) {
+                columns = names;
+                out << fmt::format("{}\n", fmt::join(columns, ","));
+            }
+
+            std::string line;
+            for (size_t i = 0; i < fields.size(); i++) {
+                line += fields[i].value;
+                line += i + 1 < fields.size() ? "," : "\n";
+            }
+            out << line << std::flush;
+        }
+
+    private:
+        Format format;
+        std::ostream& out;
+        std::vector<std::string_view> columns;
+    };
+
+    inline double seconds_since(const std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+#endif //BENCH_MAIN_H